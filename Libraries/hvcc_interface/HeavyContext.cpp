@@ -16,6 +16,10 @@
 
 #include "HeavyContext.hpp"
 #include "HvTable.h"
+#include "HvMappedFile.h"
+#include "HvSignalOscillator.h"
+
+#include <new>
 
 void defaultSendHook(HeavyContextInterface *context,
     const char *sendName, hv_uint32_t sendHash, const HvMessage *msg) {
@@ -33,6 +37,51 @@ void defaultSendHook(HeavyContextInterface *context,
   }
 }
 
+// print messages are queued with the (static) name of the print object
+typedef struct PrintMessagePair {
+  const char *printName;
+  HvMessage msg;
+} PrintMessagePair;
+
+// On the way to the host thread: a buffer to be freed (unless NULL), and then a table waiting for
+// a new buffer (unless NULL). On the way to the audio thread: a new buffer for a table.
+typedef struct TableResize {
+  HvTable *table;
+  float *buffer;
+  hv_uint32_t length;
+  hv_uint32_t serial; // the resize serial of the table when the request was made
+  bool borrowed; // the buffer holds the samples of an HvMappedFile and must not be freed
+  SignalWavetable *wavetable; // if not NULL, the buffer holds new mip-maps for this wavetable instead
+} TableResize;
+
+static void setTableResize(TableResize *r, HvTable *table, float *buffer, hv_uint32_t length, bool borrowed = false) {
+  r->table = table;
+  r->buffer = buffer;
+  r->length = length;
+  r->serial = (table != nullptr) ? table->resizeSerial : 0;
+  r->borrowed = borrowed;
+  r->wavetable = nullptr;
+}
+
+static bool pushTableResize(HvLightPipe *q, HvTable *table, float *buffer, hv_uint32_t length, bool borrowed = false) {
+  TableResize *r = reinterpret_cast<TableResize *>(hLp_getWriteBuffer(q, sizeof(TableResize)));
+  if (r == nullptr) return false;
+  setTableResize(r, table, buffer, length, borrowed);
+  hLp_produce(q, sizeof(TableResize));
+  return true;
+}
+
+static void freeTableResizes(HvLightPipe *q, bool resetTables) {
+  while (q->buffer != nullptr && hLp_hasData(q)) {
+    hv_uint32_t numBytes = 0;
+    TableResize *r = reinterpret_cast<TableResize *>(hLp_getReadBuffer(q, &numBytes));
+    if (r->buffer != nullptr && !r->borrowed) hTable_freeBuffer(r->buffer);
+    if (resetTables && r->table != nullptr) r->table->resizing = false;
+    if (resetTables && r->wavetable != nullptr) r->wavetable->version = r->wavetable->table->version - 1; // built again
+    hLp_consume(q);
+  }
+}
+
 HeavyContext::HeavyContext(double sampleRate, int poolKb, int inQueueKb, int outQueueKb) :
     sampleRate(sampleRate) {
 
@@ -41,7 +90,11 @@ HeavyContext::HeavyContext(double sampleRate, int poolKb, int inQueueKb, int out
   hv_assert(inQueueKb > 0);
   hv_assert(outQueueKb >= 0);
 
+  // the symbols compared against while processing must exist before the first message
+  hSymbol_init();
+
   blockStartTimestamp = 0;
+  arena = hArena_getActive();
   printHook = nullptr;
   userData = nullptr;
 
@@ -57,12 +110,48 @@ HeavyContext::HeavyContext(double sampleRate, int poolKb, int inQueueKb, int out
   numBytes += mq_initWithPoolSize(&mq, poolKb);
   numBytes += hLp_init(&inQueue, inQueueKb * 1024);
   numBytes += hLp_init(&outQueue, outQueueKb * 1024); // outQueueKb value of 0 sets everything to NULL
+
+  // printing is immediate until a print queue size is set
+  hLp_init(&printQueue, 0);
+  numDroppedPrintMessages = 0;
+
+  latestValueReceivers = nullptr;
+  numLatestValueReceivers = 0;
+
+  // tables are resized immediately until a resize queue size is set
+  hLp_init(&resizeQueue, 0);
+  hLp_init(&swapQueue, 0);
+  pendingResizes = nullptr;
+  wavetables = nullptr;
 }
 
 HeavyContext::~HeavyContext() {
   mq_free(&mq);
   hLp_free(&inQueue);
   hLp_free(&outQueue);
+  hLp_free(&printQueue);
+  if (numLatestValueReceivers > 0) {
+    hv_free(latestValueReceivers);
+    hPh_free(&latestValueMap);
+  }
+  // the tables have already been destroyed with the patch
+  freeTableResizes(&swapQueue, false);
+  freeTableResizes(&resizeQueue, false);
+  hLp_free(&resizeQueue);
+  hLp_free(&swapQueue);
+}
+
+void *HeavyContext::operator new(size_t numBytes) {
+  void *p = hv_arena_malloc(numBytes);
+  hv_assert(p != nullptr);
+  return p;
+}
+
+void HeavyContext::operator delete(void *p) {
+  // all destructors have run, so the arena holding the context can be released as a whole
+  HvArena *a = hArena_getOwner(p);
+  if (a != nullptr) hArena_delete(a);
+  else hv_arena_free(p);
 }
 
 bool HeavyContext::sendBangToReceiver(hv_uint32_t receiverHash) {
@@ -82,7 +171,8 @@ bool HeavyContext::sendFloatToReceiver(hv_uint32_t receiverHash, float f) {
 bool HeavyContext::sendSymbolToReceiver(hv_uint32_t receiverHash, const char *s) {
   hv_assert(s != nullptr);
   HvMessage *m = HV_MESSAGE_ON_STACK(1);
-  msg_initWithSymbol(m, 0, (char *) s);
+  msg_init(m, 1, 0);
+  if (!msg_setSymbol(m, 0, s)) return false; // the symbol table is full
   bool success = sendMessageToReceiver(receiverHash, 0.0, m);
   return success;
 }
@@ -96,36 +186,60 @@ bool HeavyContext::sendMessageToReceiverV(hv_uint32_t receiverHash, double delay
   const int numElem = (int) hv_strlen(format);
   HvMessage *m = HV_MESSAGE_ON_STACK(numElem);
   msg_init(m, numElem, blockStartTimestamp + (hv_uint32_t) (hv_max_d(0.0, delayMs)*getSampleRate()/1000.0));
+  bool interned = true;
   for (int i = 0; i < numElem; i++) {
     switch (format[i]) {
       case 'b': msg_setBang(m, i); break;
       case 'f': msg_setFloat(m, i, (float) va_arg(ap, double)); break;
       case 'h': msg_setHash(m, i, (int) va_arg(ap, int)); break;
-      case 's': msg_setSymbol(m, i, (char *) va_arg(ap, char *)); break;
+      case 's': interned &= msg_setSymbol(m, i, (char *) va_arg(ap, char *)); break;
       default: break;
     }
   }
   va_end(ap);
+  if (!interned) return false; // the symbol table is full
 
   bool success = sendMessageToReceiver(receiverHash, delayMs, m);
   return success;
 }
 
+// a float for a latest-value receiver replaces the pending value instead of being queued
+bool HeavyContext::sendLatestValue(hv_uint32_t receiverHash, double delayMs, const HvMessage *m) {
+  if ((numLatestValueReceivers > 0) && (delayMs == 0.0) && (msg_getNumElements(m) == 1) && msg_isFloat(m, 0)) {
+    const int i = hPh_find(&latestValueMap, receiverHash);
+    if (i >= 0) {
+      latestValueReceivers[i].value.store(msg_getFloat(m, 0), std::memory_order_relaxed);
+      latestValueReceivers[i].pending.store(true, std::memory_order_release);
+      return true;
+    }
+  }
+  return false;
+}
+
+// copies the message into the input queue without producing it, returns its size or 0 if it does not fit.
+// The input queue lock must be held.
+hv_uint32_t HeavyContext::writeToInputQueue(hv_uint32_t receiverHash, hv_uint32_t timestamp, const HvMessage *m) {
+  const hv_uint32_t numBytes = sizeof(ReceiverMessagePair) + msg_getSize(m) - sizeof(HvMessage);
+  ReceiverMessagePair *p = (ReceiverMessagePair *) hLp_getWriteBuffer(&inQueue, numBytes);
+  if (p == nullptr) return 0;
+  p->receiverHash = receiverHash;
+  msg_copyToBuffer(m, (char *) &p->msg, msg_getSize(m));
+  msg_setTimestamp(&p->msg, timestamp);
+  return numBytes;
+}
+
 bool HeavyContext::sendMessageToReceiver(hv_uint32_t receiverHash, double delayMs, HvMessage *m) {
   hv_assert(delayMs >= 0.0);
   hv_assert(m != nullptr);
 
+  if (sendLatestValue(receiverHash, delayMs, m)) return true;
+
   const hv_uint32_t timestamp = blockStartTimestamp +
       (hv_uint32_t) (hv_max_d(0.0, delayMs)*(getSampleRate()/1000.0));
 
-  ReceiverMessagePair *p = nullptr;
   HV_SPINLOCK_ACQUIRE(inQueueLock);
-  const hv_uint32_t numBytes = sizeof(ReceiverMessagePair) + msg_getSize(m) - sizeof(HvMessage);
-  p = (ReceiverMessagePair *) hLp_getWriteBuffer(&inQueue, numBytes);
-  if (p != nullptr) {
-    p->receiverHash = receiverHash;
-    msg_copyToBuffer(m, (char *) &p->msg, msg_getSize(m));
-    msg_setTimestamp(&p->msg, timestamp);
+  const hv_uint32_t numBytes = writeToInputQueue(receiverHash, timestamp, m);
+  if (numBytes > 0) {
     hLp_produce(&inQueue, numBytes);
   } else {
     hv_assert(false &&
@@ -133,7 +247,91 @@ bool HeavyContext::sendMessageToReceiver(hv_uint32_t receiverHash, double delayM
         "have been processed. Try increasing the inQueueKb size in the new_with_options() constructor.");
   }
   HV_SPINLOCK_RELEASE(inQueueLock);
-  return (p != nullptr);
+  return (numBytes > 0);
+}
+
+int HeavyContext::sendMessagesToReceivers(const HvMessageBatch *batch) {
+  hv_assert(batch != nullptr);
+  const double samplesPerMs = getSampleRate()/1000.0;
+  int numSent = 0;
+
+  // the first message is held back until the whole batch is in the queue, and then released
+  // with everything after it
+  char *first = nullptr;
+  hv_uint32_t firstNumBytes = 0;
+
+  HV_SPINLOCK_ACQUIRE(inQueueLock);
+  for (int i = 0; i < batch->numEntries; ++i) {
+    const HvMessageBatchEntry *e = batch->entries + i;
+    hv_assert(e->delayMs >= 0.0);
+    hv_assert(e->msg != nullptr);
+    if (!sendLatestValue(e->receiverHash, e->delayMs, e->msg)) {
+      const hv_uint32_t timestamp = blockStartTimestamp + (hv_uint32_t) (hv_max_d(0.0, e->delayMs)*samplesPerMs);
+      const hv_uint32_t numBytes = writeToInputQueue(e->receiverHash, timestamp, e->msg);
+      if (numBytes == 0) break; // the queue is full
+      if (first == nullptr) {
+        first = hLp_produceHidden(&inQueue, numBytes);
+        firstNumBytes = numBytes;
+      } else {
+        hLp_produce(&inQueue, numBytes);
+      }
+    }
+    ++numSent;
+  }
+  if (first != nullptr) hLp_publish(&inQueue, first, firstNumBytes);
+  HV_SPINLOCK_RELEASE(inQueueLock);
+  return numSent;
+}
+
+bool HeavyContext::setReceiverLatestValueOnly(hv_uint32_t receiverHash, bool enabled) {
+  const int index = (numLatestValueReceivers > 0) ? hPh_find(&latestValueMap, receiverHash) : -1;
+  if (enabled == (index >= 0)) return false;
+
+  // the receivers are rebuilt, so that lookups while processing never have to take a lock
+  const int n = numLatestValueReceivers + (enabled ? 1 : -1);
+  LatestValueReceiver *r = nullptr;
+  hv_uint32_t *hashes = nullptr;
+  if (n > 0) {
+    // hv_malloc may require sizes to be a multiple of its alignment
+    r = (LatestValueReceiver *) hv_malloc(((n * sizeof(LatestValueReceiver)) + 31) & ~((hv_size_t) 31));
+    hashes = (hv_uint32_t *) hv_alloca(n * sizeof(hv_uint32_t));
+    hv_assert(r != nullptr);
+    int j = 0;
+    for (int i = 0; i < numLatestValueReceivers; ++i) {
+      if (i == index) continue;
+      LatestValueReceiver *s = latestValueReceivers + i;
+      hashes[j] = s->receiverHash;
+      new (r + j++) LatestValueReceiver{s->receiverHash, {s->value.load()}, {s->pending.load()}};
+    }
+    if (enabled) {
+      hashes[j] = receiverHash;
+      new (r + j) LatestValueReceiver{receiverHash, {0.0f}, {false}};
+    }
+  }
+
+  if (numLatestValueReceivers > 0) {
+    hv_free(latestValueReceivers);
+    hPh_free(&latestValueMap);
+  }
+  if (n > 0) hPh_init(&latestValueMap, hashes, n);
+  latestValueReceivers = r;
+  numLatestValueReceivers = n;
+  return true;
+}
+
+void HeavyContext::applyPendingUpdates() {
+  swapTableBuffers();
+
+  for (int i = 0; i < numLatestValueReceivers; ++i) {
+    LatestValueReceiver *r = latestValueReceivers + i;
+    // clear the flag before reading, so that a value written in between is delivered next block
+    // rather than lost
+    if (r->pending.load(std::memory_order_relaxed) && r->pending.exchange(false, std::memory_order_acquire)) {
+      HvMessage *m = HV_MESSAGE_ON_STACK(1);
+      msg_initWithFloat(m, blockStartTimestamp, r->value.load(std::memory_order_relaxed));
+      scheduleMessageForReceiver(r->receiverHash, m);
+    }
+  }
 }
 
 bool HeavyContext::cancelMessage(HvMessage *m, void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
@@ -163,10 +361,45 @@ int HeavyContext::getLengthForTable(hv_uint32_t tableHash) {
 
 bool HeavyContext::setLengthForTable(hv_uint32_t tableHash, hv_uint32_t newSampleLength) {
   HvTable *t = getTableForHash(tableHash);
-  if (t != nullptr) {
-    hTable_resize(t, newSampleLength);
-    return true;
-  } else return false;
+  if (t == nullptr) return false;
+
+  // buffers in flight, a stale copy of the table or the samples of a file set before, would replace the
+  // new buffer, so they are dropped
+  t->resizeSerial++;
+  t->version++; // the host may write new samples even if the size stays the same
+  if (t->resizing) {
+    t->resizing = false;
+    for (HvTable **p = &pendingResizes; *p != nullptr; p = &(*p)->nextPendingResize) {
+      if (*p == t) {
+        *p = t->nextPendingResize;
+        t->nextPendingResize = nullptr;
+        break;
+      }
+    }
+  }
+  hTable_resize(t, newSampleLength);
+  t->requestedLength = t->length;
+
+  if (t->sendResized != nullptr) {
+    // answer the resize message of the patch with the size that the table ends up with
+    HvMessage *m = HV_MESSAGE_ON_STACK(1);
+    msg_initWithFloat(m, blockStartTimestamp, (float) hTable_getSize(t));
+    scheduleMessageForObject(m, t->sendResized, 0);
+    t->sendResized = nullptr;
+  }
+  return true;
+}
+
+bool HeavyContext::setMappedFileForTable(hv_uint32_t tableHash, const HvMappedFile *m) {
+  HvTable *t = getTableForHash(tableHash);
+  if (t == nullptr) return false;
+  if (swapQueue.buffer != nullptr) {
+    // swapped in at the start of the next block, like a resized buffer
+    return pushTableResize(&swapQueue, t, hMap_getSamples(m), hMap_getNumSamples(m), true);
+  }
+  hTable_freeBuffer(hTable_swapBuffer(t, hMap_getSamples(m), hMap_getNumSamples(m), true));
+  t->requestedLength = t->length;
+  return true;
 }
 
 void HeavyContext::lockAcquire() {
@@ -218,8 +451,213 @@ bool HeavyContext::getNextSentMessage(hv_uint32_t *destinationHash, HvMessage *o
   return (p != nullptr);
 }
 
-hv_uint32_t HeavyContext::getHashForString(const char *str) {
-  return hv_string_to_hash(str);
+int HeavyContext::processSentMessages(HvSentMessageHandler_t *f, void *userData) {
+  int numMessages = 0;
+  if (sendHook == &defaultSendHook) {
+    HV_SPINLOCK_ACQUIRE(outQueueLock);
+    while (hLp_hasData(&outQueue)) {
+      hv_uint32_t numBytes = 0;
+      ReceiverMessagePair *p = reinterpret_cast<ReceiverMessagePair *>(hLp_getReadBuffer(&outQueue, &numBytes));
+      hv_assert(numBytes >= sizeof(ReceiverMessagePair));
+      f(userData, p->receiverHash, &p->msg); // read the message in place, it is consumed afterwards
+      hLp_consume(&outQueue);
+      ++numMessages;
+    }
+    HV_SPINLOCK_RELEASE(outQueueLock);
+  }
+  return numMessages;
+}
+
+void HeavyContext::setPrintMessageQueueSize(int printQueueKb) {
+  hv_assert(printQueueKb >= 0);
+  hLp_free(&printQueue);
+  hLp_init(&printQueue, printQueueKb*1024);
+}
+
+bool HeavyContext::deferPrintMessage(const char *printName, const HvMessage *m) {
+  if (printQueue.buffer == nullptr) return false; // no print queue, print immediately
+
+  // copying the message into the queue does not allocate and never blocks
+  const hv_uint32_t numBytes = sizeof(PrintMessagePair) + msg_getSize(m) - sizeof(HvMessage);
+  PrintMessagePair *p = reinterpret_cast<PrintMessagePair *>(hLp_getWriteBuffer(&printQueue, numBytes));
+  if (p != nullptr) {
+    p->printName = printName;
+    msg_copyToBuffer(m, (char *) &p->msg, msg_getSize(m));
+    hLp_produce(&printQueue, numBytes);
+  } else {
+    numDroppedPrintMessages++;
+  }
+  return true;
+}
+
+void HeavyContext::setTableResizeQueueSize(int resizeQueueKb) {
+  hv_assert(resizeQueueKb >= 0);
+
+  // free the buffers in flight, and let their tables be resized again
+  freeTableResizes(&swapQueue, true);
+  freeTableResizes(&resizeQueue, true);
+  while (pendingResizes != nullptr) {
+    HvTable *t = pendingResizes;
+    pendingResizes = t->nextPendingResize;
+    t->nextPendingResize = nullptr;
+    t->resizing = false;
+  }
+
+  hLp_free(&resizeQueue);
+  hLp_free(&swapQueue);
+  hLp_init(&resizeQueue, resizeQueueKb*1024);
+  hLp_init(&swapQueue, resizeQueueKb*1024);
+}
+
+bool HeavyContext::requestTableResize(HvTable *o, hv_uint32_t newLength) {
+  if (resizeQueue.buffer == nullptr) return false; // no resize queue, resize immediately
+
+  o->requestedLength = newLength;
+  if (o->resizing) return true; // picked up when the buffer in flight is swapped in
+  if (hTable_sizeForLength(newLength) == o->size) {
+    o->length = newLength;
+    return true;
+  }
+  o->resizing = true;
+  if (!pushTableResize(&resizeQueue, o, nullptr, newLength)) {
+    // the queue is full, try again at the start of the next block
+    o->nextPendingResize = pendingResizes;
+    pendingResizes = o;
+  }
+  return true;
+}
+
+int HeavyContext::processTableResizes() {
+  int numResizes = 0;
+  while (resizeQueue.buffer != nullptr && hLp_hasData(&resizeQueue)) {
+    hv_uint32_t numBytes = 0;
+    TableResize *r = reinterpret_cast<TableResize *>(hLp_getReadBuffer(&resizeQueue, &numBytes));
+    hv_assert(numBytes >= sizeof(TableResize));
+    if (r->buffer != nullptr) {
+      hTable_freeBuffer(r->buffer); // retired by the audio thread
+      r->buffer = nullptr;
+    }
+    // a table that the host has resized since the request was made keeps its new buffer
+    if (r->table != nullptr && r->serial == r->table->resizeSerial) {
+      // samples the patch writes while the copy is made are not carried over
+      float *b = hTable_newBuffer(r->table, r->length);
+      if (!pushTableResize(&swapQueue, r->table, b, r->length)) {
+        hTable_freeBuffer(b);
+        break; // try again once the audio thread has caught up
+      }
+      ++numResizes;
+    }
+    hLp_consume(&resizeQueue);
+  }
+
+  // wavetables whose tables have changed get new mip-maps, which are swapped in like a resized buffer
+  for (SignalWavetable *w = wavetables; w != nullptr; w = w->next) {
+    if (w->version == w->table->version) continue;
+    TableResize *r = nullptr;
+    if (swapQueue.buffer != nullptr) {
+      // room is made before the mip-maps are built, such that they are never built in vain
+      r = reinterpret_cast<TableResize *>(hLp_getWriteBuffer(&swapQueue, sizeof(TableResize)));
+      if (r == nullptr) break; // try again once the audio thread has caught up
+    }
+    hv_uint32_t length = 0;
+    float *levels = sWavetable_newLevels(w, &length);
+    if (r != nullptr) {
+      setTableResize(r, nullptr, levels, length);
+      r->wavetable = w;
+      hLp_produce(&swapQueue, sizeof(TableResize));
+    } else {
+      hTable_freeBuffer(sWavetable_swapLevels(w, levels, length)); // no resize queue, swapped in immediately
+    }
+    ++numResizes;
+  }
+  return numResizes;
+}
+
+void HeavyContext::swapTableBuffers() {
+  while (swapQueue.buffer != nullptr && hLp_hasData(&swapQueue)) {
+    hv_uint32_t numBytes = 0;
+    TableResize *r = reinterpret_cast<TableResize *>(hLp_getReadBuffer(&swapQueue, &numBytes));
+    HvTable *o = r->table;
+
+    // the old buffer goes back to the host thread to be freed, together with a later request for the
+    // table. Room for both is made before the swap, such that nothing is ever freed on this thread.
+    TableResize *retired = reinterpret_cast<TableResize *>(hLp_getWriteBuffer(&resizeQueue, sizeof(TableResize)));
+    if (retired == nullptr) break; // try again at the next block
+
+    if (r->wavetable != nullptr) {
+      setTableResize(retired, nullptr, sWavetable_swapLevels(r->wavetable, r->buffer, r->length), 0);
+      hLp_consume(&swapQueue);
+      hLp_produce(&resizeQueue, sizeof(TableResize));
+      continue;
+    }
+
+    if (r->serial != o->resizeSerial) {
+      // the host has resized the table since this buffer was requested
+      setTableResize(retired, nullptr, r->borrowed ? nullptr : r->buffer, 0);
+      hLp_consume(&swapQueue);
+      hLp_produce(&resizeQueue, sizeof(TableResize));
+      continue;
+    }
+
+    float *oldBuffer = hTable_swapBuffer(o, r->buffer, r->length, r->borrowed);
+    hLp_consume(&swapQueue);
+    setTableResize(retired, nullptr, oldBuffer, 0);
+
+    if (o->resizing) {
+      if (hTable_sizeForLength(o->requestedLength) != o->size) {
+        // later requests made while this one was in flight
+        setTableResize(retired, o, oldBuffer, o->requestedLength);
+      } else {
+        o->length = o->requestedLength;
+        o->resizing = false;
+        if (o->sendResized != nullptr) {
+          // the table has its final size, which is sent out like any other message of this block
+          HvMessage *m = HV_MESSAGE_ON_STACK(1);
+          msg_initWithFloat(m, blockStartTimestamp, (float) hTable_getSize(o));
+          scheduleMessageForObject(m, o->sendResized, 0);
+          o->sendResized = nullptr;
+        }
+      }
+    } else {
+      o->requestedLength = o->length; // samples attached by the host
+    }
+    if (retired->table != nullptr || retired->buffer != nullptr) hLp_produce(&resizeQueue, sizeof(TableResize));
+  }
+
+  // requests that did not fit into the queue when they were made
+  while (pendingResizes != nullptr && pushTableResize(&resizeQueue, pendingResizes, nullptr, pendingResizes->requestedLength)) {
+    HvTable *o = pendingResizes;
+    pendingResizes = o->nextPendingResize;
+    o->nextPendingResize = nullptr;
+  }
+}
+
+void HeavyContext::addWavetable(SignalWavetable *o) {
+  o->next = wavetables;
+  wavetables = o;
+}
+
+int HeavyContext::processPrintMessages(int maxMessages) {
+  int numMessages = 0;
+  while (numMessages < maxMessages && printQueue.buffer != nullptr && hLp_hasData(&printQueue)) {
+    hv_uint32_t numBytes = 0;
+    PrintMessagePair *p = reinterpret_cast<PrintMessagePair *>(hLp_getReadBuffer(&printQueue, &numBytes));
+    hv_assert(numBytes >= sizeof(PrintMessagePair));
+    if (printHook != nullptr) {
+      char *s = msg_toString(&p->msg);
+      printHook(this, p->printName, s, &p->msg);
+      hv_free(s);
+    }
+    hLp_consume(&printQueue);
+    ++numMessages;
+  }
+  return numMessages;
+}
+
+MessageNode *HeavyContext::scheduleOwnedMessageForObject(const HvMessage *m,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
+    int letIndex, MessageNodeList *owner) {
+  return mq_addOwnedMessageByTimestamp(&mq, m, letIndex, sendMessage, owner);
 }
 
 HvTable *_hv_table_get(HeavyContextInterface *c, hv_uint32_t tableHash) {
@@ -227,6 +665,21 @@ HvTable *_hv_table_get(HeavyContextInterface *c, hv_uint32_t tableHash) {
   return reinterpret_cast<HeavyContext *>(c)->getTableForHash(tableHash);
 }
 
+bool _hv_deferPrintMessage(HeavyContextInterface *c, const char *printName, const HvMessage *m) {
+  hv_assert(c != nullptr);
+  return reinterpret_cast<HeavyContext *>(c)->deferPrintMessage(printName, m);
+}
+
+bool _hv_requestTableResize(HeavyContextInterface *c, HvTable *o, hv_uint32_t newLength) {
+  hv_assert(c != nullptr);
+  return reinterpret_cast<HeavyContext *>(c)->requestTableResize(o, newLength);
+}
+
+void _hv_addWavetable(HeavyContextInterface *c, SignalWavetable *o) {
+  hv_assert(c != nullptr);
+  reinterpret_cast<HeavyContext *>(c)->addWavetable(o);
+}
+
 void _hv_scheduleMessageForReceiver(HeavyContextInterface *c, hv_uint32_t receiverHash, HvMessage *m) {
   hv_assert(c != nullptr);
   reinterpret_cast<HeavyContext *>(c)->scheduleMessageForReceiver(receiverHash, m);
@@ -241,6 +694,18 @@ HvMessage *_hv_scheduleMessageForObject(HeavyContextInterface *c, const HvMessag
   return n;
 }
 
+MessageNode *_hv_scheduleOwnedMessageForObject(HeavyContextInterface *c, const HvMessage *m,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
+    int letIndex, MessageNodeList *owner) {
+  hv_assert(c != nullptr);
+  return reinterpret_cast<HeavyContext *>(c)->scheduleOwnedMessageForObject(m, sendMessage, letIndex, owner);
+}
+
+void _hv_cancelMessageNode(HeavyContextInterface *c, MessageNode *n) {
+  hv_assert(c != nullptr);
+  reinterpret_cast<HeavyContext *>(c)->cancelMessageNode(n);
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -259,6 +724,28 @@ HvMessage *hv_scheduleMessageForObject(HeavyContextInterface *c, const HvMessage
   return _hv_scheduleMessageForObject(c, m, sendMessage, letIndex);
 }
 
+MessageNode *hv_scheduleOwnedMessageForObject(HeavyContextInterface *c, const HvMessage *m,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
+    int letIndex, MessageNodeList *owner) {
+  return _hv_scheduleOwnedMessageForObject(c, m, sendMessage, letIndex, owner);
+}
+
+void hv_cancelMessageNode(HeavyContextInterface *c, MessageNode *n) {
+  _hv_cancelMessageNode(c, n);
+}
+
+bool hv_deferPrintMessage(HeavyContextInterface *c, const char *printName, const HvMessage *m) {
+  return _hv_deferPrintMessage(c, printName, m);
+}
+
+bool hv_requestTableResize(HeavyContextInterface *c, HvTable *o, hv_uint32_t newLength) {
+  return _hv_requestTableResize(c, o, newLength);
+}
+
+void hv_addWavetable(HeavyContextInterface *c, SignalWavetable *o) {
+  _hv_addWavetable(c, o);
+}
+
 #ifdef __cplusplus
 }
 #endif
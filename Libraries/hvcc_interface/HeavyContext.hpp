@@ -18,11 +18,24 @@
 #define _HEAVY_CONTEXT_H_
 
 #include "HeavyContextInterface.hpp"
+#include "HvArena.h"
 #include "HvLightPipe.h"
 #include "HvMessageQueue.h"
 #include "HvMath.h"
 
+#include "HvPerfectHash.h"
+
+#include <atomic>
+
 struct HvTable;
+struct SignalWavetable;
+
+// the newest value sent to a receiver in latest-value mode
+struct LatestValueReceiver {
+  hv_uint32_t receiverHash;
+  std::atomic<float> value;
+  std::atomic<bool> pending; // true until the value has been scheduled
+};
 
 class HeavyContext : public HeavyContextInterface {
 
@@ -30,7 +43,11 @@ class HeavyContext : public HeavyContextInterface {
   HeavyContext(double sampleRate, int poolKb=10, int inQueueKb=2, int outQueueKb=0);
   virtual ~HeavyContext();
 
-  int getSize() override { return (int) numBytes; }
+  // contexts are carved from the active arena, if there is one (see HvArena.h)
+  static void *operator new(size_t numBytes);
+  static void operator delete(void *p);
+
+  int getSize() override { return (int) ((arena != nullptr) ? hArena_getUsed(arena) : numBytes); }
 
   double getSampleRate() override { return sampleRate; }
 
@@ -55,11 +72,18 @@ class HeavyContext : public HeavyContextInterface {
   bool sendBangToReceiver(hv_uint32_t receiverHash) override;
   bool sendSymbolToReceiver(hv_uint32_t receiverHash, const char *symbol) override;
   bool cancelMessage(HvMessage *m, void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) override;
+  int sendMessagesToReceivers(const HvMessageBatch *batch) override;
+
+  // latest-value receivers
+  bool setReceiverLatestValueOnly(hv_uint32_t receiverHash, bool enabled) override;
+
+  void applyPendingUpdates() override;
 
   // table manipulation
   float *getBufferForTable(hv_uint32_t tableHash) override;
   int getLengthForTable(hv_uint32_t tableHash) override;
   bool setLengthForTable(hv_uint32_t tableHash, hv_uint32_t newSampleLength) override;
+  bool setMappedFileForTable(hv_uint32_t tableHash, const HvMappedFile *m) override;
 
   // lock control
   void lockAcquire() override;
@@ -70,9 +94,21 @@ class HeavyContext : public HeavyContextInterface {
   void setInputMessageQueueSize(int inQueueKb) override;
   void setOutputMessageQueueSize(int outQueueKb) override;
   bool getNextSentMessage(hv_uint32_t *destinationHash, HvMessage *outMsg, hv_size_t msgLength) override;
+  int processSentMessages(HvSentMessageHandler_t *f, void *userData) override;
+
+  // deferred printing
+  void setPrintMessageQueueSize(int printQueueKb) override;
+  int processPrintMessages(int maxMessages) override;
+  hv_uint32_t getNumDroppedPrintMessages() override { return numDroppedPrintMessages.exchange(0); }
+
+  // deferred table resizing
+  void setTableResizeQueueSize(int resizeQueueKb) override;
+  int processTableResizes() override;
 
   // utility functions
-  static hv_uint32_t getHashForString(const char *str);
+  static constexpr hv_uint32_t getHashForString(const char *str) {
+    return __hv_utils_string_to_hash(str);
+  }
 
  protected:
   virtual HvTable *getTableForHash(hv_uint32_t tableHash) = 0;
@@ -88,20 +124,53 @@ class HeavyContext : public HeavyContextInterface {
       void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
       int);
 
+  MessageNode *scheduleOwnedMessageForObject(const HvMessage *,
+      void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
+      int, MessageNodeList *);
+  friend MessageNode *_hv_scheduleOwnedMessageForObject(HeavyContextInterface *, const HvMessage *,
+      void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
+      int, MessageNodeList *);
+
+  void cancelMessageNode(MessageNode *n) { mq_removeNode(&mq, n); }
+  friend void _hv_cancelMessageNode(HeavyContextInterface *, MessageNode *);
+
+  bool sendLatestValue(hv_uint32_t receiverHash, double delayMs, const HvMessage *m);
+  hv_uint32_t writeToInputQueue(hv_uint32_t receiverHash, hv_uint32_t timestamp, const HvMessage *m);
+
+  bool deferPrintMessage(const char *printName, const HvMessage *m);
+  friend bool _hv_deferPrintMessage(HeavyContextInterface *, const char *, const HvMessage *);
+
+  bool requestTableResize(HvTable *o, hv_uint32_t newLength);
+  friend bool _hv_requestTableResize(HeavyContextInterface *, HvTable *, hv_uint32_t);
+  void swapTableBuffers();
+
+  void addWavetable(SignalWavetable *o);
+  friend void _hv_addWavetable(HeavyContextInterface *, SignalWavetable *);
+
   friend void defaultSendHook(HeavyContextInterface *, const char *, hv_uint32_t, const HvMessage *);
 
   // object state
   double sampleRate;
   hv_uint32_t blockStartTimestamp;
   hv_size_t numBytes;
+  HvArena *arena; // the arena holding this context, or NULL
   HvMessageQueue mq;
   HvSendHook_t *sendHook;
   HvPrintHook_t *printHook;
   void *userData;
   HvLightPipe inQueue;
   HvLightPipe outQueue;
+  HvLightPipe printQueue;
+  std::atomic<hv_uint32_t> numDroppedPrintMessages;
   hv_atomic_bool inQueueLock;
   hv_atomic_bool outQueueLock;
+  LatestValueReceiver *latestValueReceivers;
+  int numLatestValueReceivers;
+  HvPerfectHash latestValueMap; // receiver hash to index in latestValueReceivers
+  HvLightPipe resizeQueue; // resize requests and retired table buffers, from the audio thread
+  HvLightPipe swapQueue; // new table buffers, to the audio thread
+  HvTable *pendingResizes; // tables whose resize request did not fit into resizeQueue, retried every block
+  SignalWavetable *wavetables; // rebuilt by processTableResizes() when their tables change
 };
 
 #endif // _HEAVY_CONTEXT_H_
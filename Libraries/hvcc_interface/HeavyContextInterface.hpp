@@ -24,6 +24,7 @@
 
 class HeavyContextInterface;
 struct HvMessage;
+struct HvMappedFile;
 
 typedef enum {
   HV_PARAM_TYPE_PARAMETER_IN,
@@ -41,8 +42,20 @@ typedef struct HvParameterInfo {
   float defaultVal;     // the default value of this parameter
 } HvParameterInfo;
 
+typedef struct HvMessageBatchEntry {
+  hv_uint32_t receiverHash; // the hash of the receiver, e.g. from hv_stringToHash()
+  double delayMs;           // delay in milliseconds from the start of the next block
+  const HvMessage *msg;     // the message, it is copied into the queue
+} HvMessageBatchEntry;
+
+typedef struct HvMessageBatch {
+  const HvMessageBatchEntry *entries;
+  int numEntries;
+} HvMessageBatch;
+
 typedef void (HvSendHook_t) (HeavyContextInterface *context, const char *sendName, hv_uint32_t sendHash, const HvMessage *msg);
 typedef void (HvPrintHook_t) (HeavyContextInterface *context, const char *printName, const char *str, const HvMessage *msg);
+typedef void (HvSentMessageHandler_t) (void *userData, hv_uint32_t sendHash, const HvMessage *msg);
 
 #endif // _HEAVY_DECLARATIONS_
 
@@ -156,7 +169,7 @@ class HeavyContextInterface {
    * This function is thread-safe.
    *
    * @return  True if the message was accepted. False if the message could not fit onto
-   *          the message queue to be processed this block.
+   *          the message queue to be processed this block, or if the symbol table is full.
    */
   virtual bool sendMessageToReceiverV(hv_uint32_t receiverHash, double delayMs, const char *fmt, ...) = 0;
 
@@ -186,7 +199,7 @@ class HeavyContextInterface {
    * This function is thread-safe.
    *
    * @return  True if the message was accepted. False if the message could not fit onto
-   *          the message queue to be processed this block.
+   *          the message queue to be processed this block, or if the symbol table is full.
    */
   virtual bool sendSymbolToReceiver(hv_uint32_t receiverHash, const char *symbol)  = 0;
 
@@ -219,6 +232,9 @@ class HeavyContextInterface {
    *
    * Existing contents are copied to the new table. Remaining space is cleared
    * if the table is longer than the original, truncated otherwise.
+   * The table is resized immediately, even if a table resize queue is set, and a resize
+   * or a file that is in flight for the table is dropped. So this must neither run during processing
+   * nor at the same time as processTableResizes().
    *
    * @param tableHash  The table identifier.
    * @param newSampleLength  The new length of the table, in samples.
@@ -227,6 +243,18 @@ class HeavyContextInterface {
    */
   virtual bool setLengthForTable(hv_uint32_t tableHash, hv_uint32_t newSampleLength) = 0;
 
+  /**
+   * Replaces the buffer of the table with the samples of a file, without copying them.
+   * If a table resize queue is set, the samples are swapped in by applyPendingUpdates() and
+   * this must be called from the thread that calls processTableResizes().
+   *
+   * @param tableHash  The table identifier.
+   * @param m  The file, which must stay open while the table uses it.
+   *
+   * @return  False if the table could not be found or the resize queue is full. True otherwise.
+   */
+  virtual bool setMappedFileForTable(hv_uint32_t tableHash, const HvMappedFile *m) = 0;
+
   /**
    * Acquire the input message queue lock.
    *
@@ -252,6 +280,33 @@ class HeavyContextInterface {
    */
   virtual void lockRelease() = 0;
 
+  /**
+   * Sends many messages at once. The input queue is locked once for the whole batch, and the
+   * messages only become visible to the audio thread together. Messages are accepted in order
+   * until the queue is full.
+   *
+   * @return  The number of messages that were accepted.
+   */
+  virtual int sendMessagesToReceivers(const HvMessageBatch *batch) = 0;
+
+  /**
+   * Enables or disables latest-value delivery for a receiver. While it is enabled, floats sent to
+   * the receiver without a delay are not queued one by one. Each one replaces any value that has
+   * not been delivered yet, and only the newest is passed on at the start of the next block.
+   * Messages to all other receivers are queued and delivered in order as usual.
+   * Must not be called while the context is being processed.
+   *
+   * @return  True if the mode of the receiver was changed.
+   */
+  virtual bool setReceiverLatestValueOnly(hv_uint32_t receiverHash, bool enabled) = 0;
+
+  /**
+   * Applies what was prepared for the audio thread since the last block: the pending values of
+   * latest-value receivers, and the new buffers of resized tables. The hv_process*() functions
+   * call this before processing, hosts that call process() directly should call it first themselves.
+   */
+  virtual void applyPendingUpdates() = 0;
+
   /**
    * Set the size of the input message queue in kilobytes.
    *
@@ -284,8 +339,73 @@ class HeavyContextInterface {
   */
   virtual bool getNextSentMessage(hv_uint32_t *destinationHash, HvMessage *outMsg, hv_size_t msgLengthBytes) = 0;
 
-  /** Returns a 32-bit hash of any string. Returns 0 if string is NULL. */
-  static hv_uint32_t getHashForString(const char *str);
+  /**
+   * Passes every message in the outgoing queue to the handler, then consumes it.
+   * The queue is locked once for the whole pass. The message pointer is only
+   * valid during the call to the handler.
+   *
+   * @return  The number of messages that were processed.
+   */
+  virtual int processSentMessages(HvSentMessageHandler_t *f, void *userData) = 0;
+
+  /**
+   * Set the size of the print message queue in kilobytes.
+   *
+   * If the size is positive, print messages are copied into the queue on the
+   * audio thread and only formatted and passed to the print hook when
+   * processPrintMessages() is called. A size of 0 calls the print hook directly.
+   * The buffer is reset and all existing contents are lost on resize.
+   *
+   * @param printQueueKb  Must be zero or positive.
+   */
+  virtual void setPrintMessageQueueSize(int printQueueKb) = 0;
+
+  /**
+   * Formats queued print messages and passes them to the print hook.
+   * Must not be called from the audio thread.
+   *
+   * @param maxMessages  The maximum number of messages to process in this call.
+   *
+   * @return  The number of messages that were printed.
+   */
+  virtual int processPrintMessages(int maxMessages) = 0;
+
+  /**
+   * Returns the number of print messages that were dropped because the print
+   * queue was full, since the last call to this function.
+   */
+  virtual hv_uint32_t getNumDroppedPrintMessages() = 0;
+
+  /**
+   * Set the size of the table resize queues in kilobytes.
+   *
+   * If the size is positive, a table that receives a resize message does not allocate
+   * on the audio thread. Its new buffer is allocated and filled by processTableResizes(),
+   * swapped in by applyPendingUpdates() and the old buffer is freed by the next call to
+   * processTableResizes(). The table sends out its new size in the block in which the buffer
+   * is swapped in. Requests that find the queue full are retried at the start of each block.
+   * A size of 0 resizes tables immediately.
+   * The queues are reset on resize, so this must be called before processing starts.
+   *
+   * @param resizeQueueKb  Must be zero or positive.
+   */
+  virtual void setTableResizeQueueSize(int resizeQueueKb) = 0;
+
+  /**
+   * Prepares the buffers of tables that are waiting to be resized, and frees the buffers
+   * that resized tables no longer use. Also rebuilds the mip-maps of wavetables whose tables
+   * have a new buffer or length. Without a table resize queue, the new mip-maps are swapped in
+   * immediately, so this must then not run during processing.
+   * Must not be called from the audio thread, and only from one thread at a time.
+   *
+   * @return  The number of new table buffers and mip-maps that were prepared.
+   */
+  virtual int processTableResizes() = 0;
+
+  /** Returns a 32-bit hash of any string. Returns 0 if string is NULL. String literals are hashed at compile time. */
+  static constexpr hv_uint32_t getHashForString(const char *str) {
+    return __hv_utils_string_to_hash(str);
+  }
 };
 
 #endif // _HEAVY_CONTEXT_INTERFACE_H_
@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "HvArena.h"
+
+#if HV_WIN
+  #define HV_THREAD_LOCAL __declspec(thread)
+#else
+  #include <sys/mman.h>
+  #define HV_THREAD_LOCAL __thread
+#endif
+
+#define HV_ARENA_HUGE_PAGE_SIZE (2*1024*1024)
+
+// identifies the tag in front of every block from hArena_malloc()
+#define HV_ARENA_TAG_MAGIC 0x41524E41
+
+typedef struct HvArenaTag {
+  HvArena *arena; // the owning arena, or NULL for the heap
+  hv_uint32_t magic;
+} HvArenaTag;
+
+static HV_THREAD_LOCAL HvArena *activeArena = NULL;
+
+static inline hv_size_t hArena_align(hv_size_t numBytes) {
+  return (numBytes + (HV_ARENA_ALIGNMENT-1)) & ~((hv_size_t) (HV_ARENA_ALIGNMENT-1));
+}
+
+// a whole alignment unit keeps the block that follows the tag on a cache line
+static inline HvArenaTag *hArena_tag(const void *p) {
+  return (HvArenaTag *) (((char *) p) - HV_ARENA_ALIGNMENT);
+}
+
+static char *hArena_reserve(hv_size_t *numBytes, int flags, bool *mapped) {
+#if HV_WIN
+  *mapped = false;
+  char *buffer = (char *) _aligned_malloc(*numBytes, HV_ARENA_ALIGNMENT);
+  if (buffer != NULL) {
+    hv_memclear(buffer, *numBytes);
+    if (flags & HV_ARENA_LOCKED) VirtualLock(buffer, *numBytes);
+  }
+  return buffer;
+#else
+  char *buffer = NULL;
+  *mapped = true;
+#ifdef MAP_HUGETLB
+  if (flags & HV_ARENA_HUGE_PAGES) {
+    // explicit huge pages are only available if the system has reserved them
+    const hv_size_t hugeBytes = (*numBytes + HV_ARENA_HUGE_PAGE_SIZE - 1) & ~((hv_size_t) HV_ARENA_HUGE_PAGE_SIZE - 1);
+    void *p = mmap(NULL, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+      buffer = (char *) p;
+      *numBytes = hugeBytes;
+    }
+  }
+#endif
+  if (buffer == NULL) {
+    void *p = mmap(NULL, *numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+    buffer = (char *) p;
+#ifdef MADV_HUGEPAGE
+    // otherwise ask for transparent huge pages
+    if (flags & HV_ARENA_HUGE_PAGES) madvise(buffer, *numBytes, MADV_HUGEPAGE);
+#endif
+  }
+  // failing to lock (e.g. because of RLIMIT_MEMLOCK) is not fatal
+  if (flags & HV_ARENA_LOCKED) mlock(buffer, *numBytes);
+  return buffer; // mapped memory is already zeroed
+#endif
+}
+
+static void hArena_release(char *buffer, hv_size_t numBytes, int flags, bool mapped) {
+#if HV_WIN
+  if (flags & HV_ARENA_LOCKED) VirtualUnlock(buffer, numBytes);
+  _aligned_free(buffer);
+#else
+  if (flags & HV_ARENA_LOCKED) munlock(buffer, numBytes);
+  if (mapped) munmap(buffer, numBytes);
+#endif
+}
+
+static HvArenaChunk *hArena_newChunk(hv_size_t numBytes, int flags) {
+  hv_size_t size = numBytes;
+  bool mapped = false;
+  char *buffer = hArena_reserve(&size, flags, &mapped);
+  if (buffer == NULL) return NULL;
+
+  HvArenaChunk *c = (HvArenaChunk *) buffer;
+  c->size = size;
+  c->used = hArena_align(sizeof(HvArenaChunk));
+  c->mapped = mapped;
+  c->next = NULL;
+  return c;
+}
+
+HvArena *hArena_new(hv_size_t numBytes, int flags) {
+  const hv_size_t headerBytes = hArena_align(sizeof(HvArenaChunk)) + hArena_align(sizeof(HvArena));
+  HvArenaChunk *c = hArena_newChunk(headerBytes + hArena_align(numBytes), flags);
+  if (c == NULL) return NULL;
+
+  HvArena *a = (HvArena *) (((char *) c) + c->used);
+  c->used = headerBytes;
+  a->chunk = c;
+  a->size = c->size;
+  a->flags = flags;
+  return a;
+}
+
+void hArena_delete(HvArena *a) {
+  if (a == NULL) return;
+  if (activeArena == a) activeArena = NULL;
+
+  // the first chunk holds the arena itself, so nothing may be read from it after its release
+  const int flags = a->flags;
+  HvArenaChunk *c = a->chunk;
+  while (c != NULL) {
+    HvArenaChunk *const next = c->next;
+    hArena_release((char *) c, c->size, flags, c->mapped);
+    c = next;
+  }
+}
+
+void *hArena_alloc(HvArena *a, hv_size_t numBytes) {
+  const hv_size_t n = hArena_align(numBytes);
+  HvArenaChunk *c = a->chunk;
+  if (c->used + n > c->size) {
+    // grow by at least the size of the last chunk, so that the number of chunks stays small
+    const hv_size_t minBytes = hArena_align(sizeof(HvArenaChunk)) + n;
+    c = hArena_newChunk((minBytes > c->size) ? minBytes : c->size, a->flags);
+    if (c == NULL) return NULL;
+    c->next = a->chunk;
+    a->chunk = c;
+    a->size += c->size;
+  }
+  void *p = ((char *) c) + c->used;
+  c->used += n;
+  return p;
+}
+
+void *hArena_malloc(HvArena *a, hv_size_t numBytes) {
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const hv_size_t n = HV_ARENA_ALIGNMENT + hArena_align(numBytes);
+  char *const block = (char *) ((a != NULL) ? hArena_alloc(a, n) : hv_malloc(n));
+  if (block == NULL) return NULL;
+  char *const p = block + HV_ARENA_ALIGNMENT;
+  HvArenaTag *const t = hArena_tag(p);
+  t->arena = a;
+  t->magic = HV_ARENA_TAG_MAGIC;
+  return p;
+}
+
+HvArena *hArena_getOwner(const void *p) {
+  const HvArenaTag *const t = hArena_tag(p);
+  hv_assert(t->magic == HV_ARENA_TAG_MAGIC); // the block did not come from hArena_malloc()
+  return t->arena;
+}
+
+void hArena_setActive(HvArena *a) {
+  activeArena = a;
+}
+
+HvArena *hArena_getActive(void) {
+  return activeArena;
+}
+
+void *hv_arena_malloc(hv_size_t numBytes) {
+  return hArena_malloc(activeArena, numBytes);
+}
+
+void hv_arena_free(void *p) {
+  if (p != NULL && hArena_getOwner(p) == NULL) {
+    hv_free(hArena_tag(p));
+  }
+}
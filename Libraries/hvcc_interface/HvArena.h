@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef _HEAVY_ARENA_H_
+#define _HEAVY_ARENA_H_
+
+#include "HvUtils.h"
+
+// every allocation from the arena starts on a cache line
+#define HV_ARENA_ALIGNMENT 64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum HvArenaFlags {
+  HV_ARENA_DEFAULT = 0,
+  HV_ARENA_HUGE_PAGES = 1, // back the arena with huge pages, if the platform supports it
+  HV_ARENA_LOCKED = 2      // lock the arena in physical memory so that it is never paged out
+} HvArenaFlags;
+
+typedef struct HvArenaChunk {
+  hv_size_t size; // in bytes, starting with this header
+  hv_size_t used; // the number of bytes handed out so far
+  bool mapped; // the chunk was mapped from the OS rather than taken from the heap
+  struct HvArenaChunk *next; // the previously filled chunk
+} HvArenaChunk;
+
+typedef struct HvArena {
+  HvArenaChunk *chunk; // the chunk currently allocated from, the first one also holds this header
+  hv_size_t size; // in bytes, over all chunks
+  int flags;
+} HvArena;
+
+/**
+ * The HvArena carves the memory of a context from a few large aligned allocations. A host creates an
+ * arena with an estimate of the footprint of the context (e.g. the getSize() of a previous instance)
+ * and makes it active while constructing the context. When the arena runs out of space it adds another
+ * chunk, at least as large as the last one, so a low estimate costs an extra allocation and nothing else.
+ *
+ * Allocations made through hv_arena_malloc() are taken from the active arena, or from the heap if no
+ * arena is active. Every block is preceded by a tag naming its owner, so hv_arena_free() releases heap
+ * blocks and ignores arena blocks without searching for the arena or taking a lock. Arena memory is
+ * released all at once with hArena_delete().
+ *
+ * The active arena is per thread. An arena must not be allocated from by two threads at once.
+ */
+
+/**
+ * Creates an arena with room for numBytes of allocations. The arena header is placed at the start
+ * of its own buffer.
+ * @return  Returns the arena, or NULL if the memory could not be reserved.
+ */
+HvArena *hArena_new(hv_size_t numBytes, int flags);
+
+/** Releases the arena and all memory carved from it. */
+void hArena_delete(HvArena *a);
+
+/**
+ * Returns an aligned, untagged block of numBytes from the arena, adding a chunk if necessary. The block
+ * can only be released with the arena. Returns NULL if no more memory could be reserved.
+ */
+void *hArena_alloc(HvArena *a, hv_size_t numBytes);
+
+/** Returns a tagged block of numBytes from the given arena, or from the heap if it is NULL. */
+void *hArena_malloc(HvArena *a, hv_size_t numBytes);
+
+/** Returns the arena that owns a block returned by hArena_malloc() or hv_arena_malloc(), or NULL. */
+HvArena *hArena_getOwner(const void *p);
+
+/** Returns the total size of the arena in bytes, including its headers. */
+static inline hv_size_t hArena_getSize(const HvArena *a) {
+  return a->size;
+}
+
+/**
+ * Returns the number of bytes handed out by the arena, including its headers. Unlike hArena_getSize(),
+ * this does not count the unused space of a chunk, which may be as large as all of the previous chunks
+ * after the arena has grown. It is the size to create the arena of a later instance with.
+ */
+static inline hv_size_t hArena_getUsed(const HvArena *a) {
+  hv_size_t used = 0;
+  for (const HvArenaChunk *c = a->chunk; c != NULL; c = c->next) used += c->used;
+  return used;
+}
+
+/** Sets the arena used by hv_arena_malloc() on this thread. NULL allocates from the heap. */
+void hArena_setActive(HvArena *a);
+
+HvArena *hArena_getActive(void);
+
+/** Allocates a tagged block from the active arena if there is one, otherwise from the heap. */
+void *hv_arena_malloc(hv_size_t numBytes);
+
+/** Frees memory returned by hv_arena_malloc(). Does nothing for arena memory or NULL. */
+void hv_arena_free(void *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HEAVY_ARENA_H_
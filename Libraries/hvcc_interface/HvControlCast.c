@@ -27,9 +27,12 @@ void cCast_onMessage(HeavyContextInterface *_c, CastType castType, int letIn, co
     }
     case HV_CAST_FLOAT: {
       if (msg_isFloat(m, 0)) {
-        HvMessage *n = HV_MESSAGE_ON_STACK(1);
-        msg_initWithFloat(n, msg_getTimestamp(m), msg_getFloat(m, 0));
-        sendMessage(_c, 0, n);
+        if (msg_getNumElements(m) == 1) {
+          sendMessage(_c, 0, m);
+        } else {
+          HvMessageView v; // only the first element is passed on
+          sendMessage(_c, 0, msg_initView(&v, m, 0, 1, msg_getTimestamp(m)));
+        }
       }
       break;
     }
@@ -37,13 +40,15 @@ void cCast_onMessage(HeavyContextInterface *_c, CastType castType, int letIn, co
       switch (msg_getType(m, 0)) {
         case HV_MSG_BANG: {
           HvMessage *n = HV_MESSAGE_ON_STACK(1);
-          msg_initWithSymbol(n, msg_getTimestamp(m), "bang");
+          msg_init(n, 1, msg_getTimestamp(m));
+          msg_setBuiltinSymbol(n, 0, HV_SYMBOL_bang);
           sendMessage(_c, 0, n);
           break;
         }
         case HV_MSG_FLOAT: {
           HvMessage *n = HV_MESSAGE_ON_STACK(1);
-          msg_initWithSymbol(n, msg_getTimestamp(m), "float");
+          msg_init(n, 1, msg_getTimestamp(m));
+          msg_setBuiltinSymbol(n, 0, HV_SYMBOL_float);
           sendMessage(_c, 0, n);
           break;
         }
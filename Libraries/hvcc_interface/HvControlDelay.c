@@ -18,7 +18,7 @@
 
 hv_size_t cDelay_init(HeavyContextInterface *_c, ControlDelay *o, float delayMs) {
   o->delay = hv_millisecondsToSamples(_c, delayMs);
-  hv_memclear(o->msgs, __HV_DELAY_MAX_MESSAGES*sizeof(HvMessage *));
+  mq_list_init(&o->pending);
   return 0;
 }
 
@@ -26,40 +26,28 @@ void cDelay_onMessage(HeavyContextInterface *_c, ControlDelay *o, int letIn, con
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
   switch (letIn) {
     case 0: {
-      if (msg_compareSymbol(m, 0, "flush")) {
-        // send all messages immediately
-        for (int i = 0; i < __HV_DELAY_MAX_MESSAGES; i++) {
-          HvMessage *n = o->msgs[i];
-          if (n != NULL) {
-            msg_setTimestamp(n, msg_getTimestamp(m)); // update the timestamp to now
-            sendMessage(_c, 0, n); // send the message
-            hv_cancelMessage(_c, n, sendMessage); // then clear it
-            // NOTE(mhroth): there may be a problem here if a flushed message causes a clear message to return
-            // to this object in the same step
-          }
+      if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_flush)) {
+        // send all messages immediately. The pending list is detached first so that any messages
+        // scheduled or cleared as a result of the flush do not interfere with the iteration.
+        MessageNodeList flushing;
+        mq_list_init(&flushing);
+        mq_list_moveAll(&flushing, &o->pending);
+        while (!mq_list_isEmpty(&flushing)) {
+          MessageNode *n = flushing.head;
+          mq_list_remove(n);
+          msg_setTimestamp(n->m, msg_getTimestamp(m)); // update the timestamp to now
+          sendMessage(_c, 0, n->m); // send the message
+          hv_cancelMessageNode(_c, n); // then clear it
         }
-        hv_memclear(o->msgs, __HV_DELAY_MAX_MESSAGES*sizeof(HvMessage *));
-      } else if (msg_compareSymbol(m, 0, "clear")) {
+      } else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_clear)) {
         // cancel (clear) all (pending) messages
-        for (int i = 0; i < __HV_DELAY_MAX_MESSAGES; i++) {
-          HvMessage *n = o->msgs[i];
-          if (n != NULL) {
-            hv_cancelMessage(_c, n, sendMessage);
-          }
+        while (!mq_list_isEmpty(&o->pending)) {
+          hv_cancelMessageNode(_c, o->pending.head);
         }
-        hv_memclear(o->msgs, __HV_DELAY_MAX_MESSAGES*sizeof(HvMessage *));
       } else {
         hv_uint32_t ts = msg_getTimestamp(m);
         msg_setTimestamp((HvMessage *) m, ts+o->delay); // update the timestamp to set the delay
-        int i;
-        for (i = 0; i < __HV_DELAY_MAX_MESSAGES; i++) {
-          if (o->msgs[i] == NULL) {
-            o->msgs[i] = hv_scheduleMessageForObject(_c, m, sendMessage, 0);
-            break;
-          }
-        }
-        hv_assert((i < __HV_DELAY_MAX_MESSAGES) && // scheduled message limit reached
-            "[__delay] cannot track any more messages. Try increasing the size of __HV_DELAY_MAX_MESSAGES.");
+        hv_scheduleOwnedMessageForObject(_c, m, sendMessage, 0, &o->pending);
         msg_setTimestamp((HvMessage *) m, ts); // return to the original timestamp
       }
       break;
@@ -83,9 +71,11 @@ void cDelay_onMessage(HeavyContextInterface *_c, ControlDelay *o, int letIn, con
 }
 
 void cDelay_clearExecutingMessage(ControlDelay *o, const HvMessage *m) {
-  for (int i = 0; i < __HV_DELAY_MAX_MESSAGES; ++i) {
-    if (o->msgs[i] == m) {
-      o->msgs[i] = NULL;
+  // the queue also unlinks the node when the message is popped, this only stops it being
+  // flushed or cleared while it is being sent
+  for (MessageNode *n = o->pending.head; n != NULL; n = n->ownerNext) {
+    if (n->m == m) {
+      mq_list_remove(n);
       break;
     }
   }
@@ -17,8 +17,6 @@
 #ifndef _HEAVY_CONTROL_DELAY_H_
 #define _HEAVY_CONTROL_DELAY_H_
 
-#define __HV_DELAY_MAX_MESSAGES 8
-
 #include "HvHeavyInternal.h"
 
 #ifdef __cplusplus
@@ -27,7 +25,7 @@ extern "C" {
 
 typedef struct ControlDelay {
   hv_uint32_t delay; // delay in samples
-  HvMessage *msgs[__HV_DELAY_MAX_MESSAGES];
+  MessageNodeList pending; // scheduled messages which have not yet been sent
 } ControlDelay;
 
 hv_size_t cDelay_init(HeavyContextInterface *_c, ControlDelay *o, float delayMs);
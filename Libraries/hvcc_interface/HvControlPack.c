@@ -18,7 +18,7 @@
 
 hv_size_t cPack_init(ControlPack *o, int nargs, ...) {
   hv_size_t numBytes = msg_getCoreSize(nargs);
-  o->msg = (HvMessage *) hv_malloc(numBytes);
+  o->msg = (HvMessage *) hv_arena_malloc(numBytes);
   hv_assert(o->msg != NULL);
   msg_init(o->msg, nargs, 0);
 
@@ -33,7 +33,7 @@ hv_size_t cPack_init(ControlPack *o, int nargs, ...) {
 }
 
 void cPack_free(ControlPack *o) {
-  hv_free(o->msg);
+  hv_arena_free(o->msg);
 }
 
 void cPack_onMessage(HeavyContextInterface *_c, ControlPack *o, int letIn, const HvMessage *m,
@@ -17,7 +17,7 @@
 #include "HvControlPrint.h"
 
 void cPrint_onMessage(HeavyContextInterface *_c, const HvMessage *m, const char *name) {
-  if (hv_getPrintHook(_c) != NULL) {
+  if (hv_getPrintHook(_c) != NULL && !hv_deferPrintMessage(_c, name, m)) {
     char *s = msg_toString(m);
     hv_getPrintHook(_c)(_c, name, s, m);
     hv_free(s);
@@ -16,11 +16,8 @@
 
 #include "HvControlRandom.h"
 
-// http://www.firstpr.com.au/dsp/rand31
-// http://en.wikipedia.org/wiki/Lehmer_random_number_generator
-
 hv_size_t cRandom_init(ControlRandom *o, int seed) {
-  o->state = (seed != 0) ? seed : 1;
+  hv_random_seed(o->state, (hv_uint32_t) seed);
   return 0;
 }
 
@@ -29,15 +26,14 @@ void cRandom_onMessage(HeavyContextInterface *_c, ControlRandom *o, int inletInd
   switch (inletIndex) {
     case 0: {
       HvMessage *n = HV_MESSAGE_ON_STACK(1);
-      o->state = (hv_uint32_t) ((((unsigned long long) o->state) * 279470273UL) % 4294967291UL);
-      float f = ((float) (o->state >> 9)) * 0.00000011920929f;
+      float f = ((float) (hv_random_next(o->state) >> 9)) * 0.00000011920929f;
       msg_initWithFloat(n, msg_getTimestamp(m), f);
       sendMessage(_c, 0, n);
       break;
     }
     case 1: {
       if (msg_isFloat(m,0)) {
-        o->state = (hv_uint32_t) msg_getFloat(m,0);
+        hv_random_seed(o->state, (hv_uint32_t) msg_getFloat(m,0));
       }
       break;
     }
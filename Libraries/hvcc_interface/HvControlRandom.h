@@ -24,7 +24,7 @@ extern "C" {
 #endif
 
 typedef struct ControlRandom {
-  hv_uint32_t state;
+  hv_uint32_t state[4]; // xoshiro128+, the same generator as __hv_noise_f
 } ControlRandom;
 
 hv_size_t cRandom_init(ControlRandom *o, int seed);
@@ -30,10 +30,13 @@ void cSlice_onMessage(HeavyContextInterface *_c, ControlSlice *o, int letIn, con
       if (o->i < msg_getNumElements(m)) {
         int x = msg_getNumElements(m) - o->i; // number of elements in the new message
         if (o->n > 0) x = hv_min_i(x, o->n);
-        HvMessage *n = HV_MESSAGE_ON_STACK(x);
-        msg_init(n, x, msg_getTimestamp(m));
-        hv_memcpy(&n->elem, &m->elem+o->i, x*sizeof(Element));
-        sendMessage(_c, 0, n);
+        if (x == msg_getNumElements(m)) {
+          sendMessage(_c, 0, m); // the slice is the whole message
+        } else {
+          // send a view onto the sliced elements, it is only copied if something downstream keeps it
+          HvMessageView v;
+          sendMessage(_c, 0, msg_initView(&v, m, o->i, x, msg_getTimestamp(m)));
+        }
       } else {
         // if nothing can be sliced, send a bang out of the right outlet
         HvMessage *n = HV_MESSAGE_ON_STACK(1);
@@ -20,24 +20,24 @@ void cSystem_onMessage(HeavyContextInterface *_c, void *o, int letIn, const HvMe
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
 
   HvMessage *n = HV_MESSAGE_ON_STACK(1);
-  if (msg_compareSymbol(m, 0, "samplerate")) {
+  if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_samplerate)) {
 
     msg_initWithFloat(n, msg_getTimestamp(m), (float) hv_getSampleRate(_c));
-  } else if (msg_compareSymbol(m, 0, "numInputChannels")) {
+  } else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_numInputChannels)) {
     msg_initWithFloat(n, msg_getTimestamp(m), (float) hv_getNumInputChannels(_c));
-  } else if (msg_compareSymbol(m, 0, "numOutputChannels")) {
+  } else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_numOutputChannels)) {
     msg_initWithFloat(n, msg_getTimestamp(m), (float) hv_getNumOutputChannels(_c));
-  } else if (msg_compareSymbol(m, 0, "currentTime")) {
+  } else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_currentTime)) {
     msg_initWithFloat(n, msg_getTimestamp(m), (float) msg_getTimestamp(m));
-  } else if (msg_compareSymbol(m, 0, "table")) {
+  } else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_table)) {
     // NOTE(mhroth): no need to check message format for symbols as table lookup will fail otherwise
     HvTable *table = hv_table_get(_c, msg_getHash(m,1));
     if (table != NULL) {
-      if (msg_compareSymbol(m, 2, "length")) {
+      if (msg_compareBuiltinSymbol(m, 2, HV_SYMBOL_length)) {
         msg_initWithFloat(n, msg_getTimestamp(m), (float) hTable_getLength(table));
-      } else if (msg_compareSymbol(m, 2, "size")) {
+      } else if (msg_compareBuiltinSymbol(m, 2, HV_SYMBOL_size)) {
         msg_initWithFloat(n, msg_getTimestamp(m), (float) hTable_getSize(table));
-      } else if (msg_compareSymbol(m, 2, "head")) {
+      } else if (msg_compareBuiltinSymbol(m, 2, HV_SYMBOL_head)) {
         msg_initWithFloat(n, msg_getTimestamp(m), (float) hTable_getHead(table));
       } else return;
     } else return;
@@ -29,6 +29,11 @@ HV_EXPORT bool hv_table_setLength(HeavyContextInterface *c, hv_uint32_t tableHas
   return c->setLengthForTable(tableHash, newSampleLength);
 }
 
+HV_EXPORT bool hv_table_setMappedFile(HeavyContextInterface *c, hv_uint32_t tableHash, const HvMappedFile *m) {
+  hv_assert(c != nullptr);
+  return c->setMappedFileForTable(tableHash, m);
+}
+
 HV_EXPORT float *hv_table_getBuffer(HeavyContextInterface *c, hv_uint32_t tableHash) {
   hv_assert(c != nullptr);
   return c->getBufferForTable(tableHash);
@@ -93,8 +98,8 @@ HV_EXPORT const char *hv_msg_getSymbol(const HvMessage *const m, int i) {
   return msg_getSymbol(m,i);
 }
 
-HV_EXPORT void hv_msg_setSymbol(HvMessage *m, int i, const char *s) {
-  msg_setSymbol(m,i,s);
+HV_EXPORT bool hv_msg_setSymbol(HvMessage *m, int i, const char *s) {
+  return msg_setSymbol(m,i,s);
 }
 
 HV_EXPORT bool hv_msg_isHash(const HvMessage *const m, int i) {
@@ -192,16 +197,18 @@ HV_EXPORT bool hv_sendMessageToReceiverV(
   const int numElem = (int) hv_strlen(format);
   HvMessage *m = HV_MESSAGE_ON_STACK(numElem);
   msg_init(m, numElem, c->getCurrentSample() + (hv_uint32_t) (hv_max_d(0.0, delayMs)*c->getSampleRate()/1000.0));
+  bool interned = true;
   for (int i = 0; i < numElem; i++) {
     switch (format[i]) {
       case 'b': msg_setBang(m, i); break;
       case 'f': msg_setFloat(m, i, (float) va_arg(ap, double)); break;
       case 'h': msg_setHash(m, i, (int) va_arg(ap, int)); break;
-      case 's': msg_setSymbol(m, i, (char *) va_arg(ap, char *)); break;
+      case 's': interned &= msg_setSymbol(m, i, (char *) va_arg(ap, char *)); break;
       default: break;
     }
   }
   va_end(ap);
+  if (!interned) return false; // the symbol table is full
 
   return c->sendMessageToReceiver(receiverHash, delayMs, m);
 }
@@ -217,6 +224,17 @@ HV_EXPORT void hv_cancelMessage(HeavyContextInterface *c, HvMessage *m, void (*s
   c->cancelMessage(m, sendMessage);
 }
 
+HV_EXPORT int hv_sendMessages(HeavyContextInterface *c, const HvMessageBatch *batch) {
+  hv_assert(c != nullptr);
+  hv_assert(batch != nullptr);
+  return c->sendMessagesToReceivers(batch);
+}
+
+HV_EXPORT bool hv_setReceiverLatestValueOnly(HeavyContextInterface *c, hv_uint32_t receiverHash, bool enabled) {
+  hv_assert(c != nullptr);
+  return c->setReceiverLatestValueOnly(receiverHash, enabled);
+}
+
 HV_EXPORT const char *hv_getName(HeavyContextInterface *c) {
   hv_assert(c != nullptr);
   return c->getName();
@@ -289,6 +307,37 @@ HV_EXPORT bool hv_getNextSentMessage(HeavyContextInterface *c, hv_uint32_t *dest
   return c->getNextSentMessage(destinationHash, outMsg, msgLength);
 }
 
+HV_EXPORT int hv_processSentMessages(HeavyContextInterface *c, HvSentMessageHandler_t *f, void *userData) {
+  hv_assert(c != nullptr);
+  hv_assert(f != nullptr);
+  return c->processSentMessages(f, userData);
+}
+
+HV_EXPORT void hv_setPrintMessageQueueSize(HeavyContextInterface *c, hv_uint32_t printQueueKb) {
+  hv_assert(c != nullptr);
+  c->setPrintMessageQueueSize(printQueueKb);
+}
+
+HV_EXPORT int hv_processPrintMessages(HeavyContextInterface *c, int maxMessages) {
+  hv_assert(c != nullptr);
+  return c->processPrintMessages(maxMessages);
+}
+
+HV_EXPORT hv_uint32_t hv_getNumDroppedPrintMessages(HeavyContextInterface *c) {
+  hv_assert(c != nullptr);
+  return c->getNumDroppedPrintMessages();
+}
+
+HV_EXPORT void hv_setTableResizeQueueSize(HeavyContextInterface *c, hv_uint32_t resizeQueueKb) {
+  hv_assert(c != nullptr);
+  c->setTableResizeQueueSize(resizeQueueKb);
+}
+
+HV_EXPORT int hv_processTableResizes(HeavyContextInterface *c) {
+  hv_assert(c != nullptr);
+  return c->processTableResizes();
+}
+
 
 #if !HV_WIN
 #pragma mark - Heavy Common
@@ -296,16 +345,19 @@ HV_EXPORT bool hv_getNextSentMessage(HeavyContextInterface *c, hv_uint32_t *dest
 
 HV_EXPORT int hv_process(HeavyContextInterface *c, float **inputBuffers, float **outputBuffers, int n) {
   hv_assert(c != nullptr);
+  c->applyPendingUpdates();
   return c->process(inputBuffers, outputBuffers, n);
 }
 
 HV_EXPORT int hv_processInline(HeavyContextInterface *c, float *inputBuffers, float *outputBuffers, int n) {
   hv_assert(c != nullptr);
+  c->applyPendingUpdates();
   return c->processInline(inputBuffers, outputBuffers, n);
 }
 
 HV_EXPORT int hv_processInlineInterleaved(HeavyContextInterface *c, float *inputBuffers, float *outputBuffers, int n) {
   hv_assert(c != nullptr);
+  c->applyPendingUpdates();
   return c->processInlineInterleaved(inputBuffers, outputBuffers, n);
 }
 
@@ -33,6 +33,7 @@ typedef struct HeavyContextInterface HeavyContextInterface;
 #endif
 
 typedef struct HvMessage HvMessage;
+typedef struct HvMappedFile HvMappedFile;
 
 typedef enum {
   HV_PARAM_TYPE_PARAMETER_IN,
@@ -50,8 +51,20 @@ typedef struct HvParameterInfo {
   float defaultVal;     // the default value of this parameter
 } HvParameterInfo;
 
+typedef struct HvMessageBatchEntry {
+  hv_uint32_t receiverHash; // the hash of the receiver, e.g. from hv_stringToHash()
+  double delayMs;           // delay in milliseconds from the start of the next block
+  const HvMessage *msg;     // the message, it is copied into the queue
+} HvMessageBatchEntry;
+
+typedef struct HvMessageBatch {
+  const HvMessageBatchEntry *entries;
+  int numEntries;
+} HvMessageBatch;
+
 typedef void (HvSendHook_t) (HeavyContextInterface *context, const char *sendName, hv_uint32_t sendHash, const HvMessage *msg);
 typedef void (HvPrintHook_t) (HeavyContextInterface *context, const char *printName, const char *str, const HvMessage *msg);
+typedef void (HvSentMessageHandler_t) (void *userData, hv_uint32_t sendHash, const HvMessage *msg);
 
 #endif // _HEAVY_DECLARATIONS_
 
@@ -175,7 +188,7 @@ bool hv_sendFloatToReceiver(HeavyContextInterface *c, hv_uint32_t receiverHash,
  * This function is thread-safe.
  *
  * @return  True if the message was accepted. False if the message could not fit onto
- *          the message queue to be processed this block.
+ *          the message queue to be processed this block, or if the symbol table is full.
  */
 bool hv_sendSymbolToReceiver(HeavyContextInterface *c, hv_uint32_t receiverHash, char *s);
 
@@ -185,7 +198,7 @@ bool hv_sendSymbolToReceiver(HeavyContextInterface *c, hv_uint32_t receiverHash,
  * This function is thread-safe.
  *
  * @return  True if the message was accepted. False if the message could not fit onto
- *          the message queue to be processed this block.
+ *          the message queue to be processed this block, or if the symbol table is full.
  */
 bool hv_sendMessageToReceiverV(HeavyContextInterface *c, hv_uint32_t receiverHash, double delayMs, const char *format, ...);
 
@@ -199,6 +212,18 @@ bool hv_sendMessageToReceiverV(HeavyContextInterface *c, hv_uint32_t receiverHas
  */
 bool hv_sendMessageToReceiver(HeavyContextInterface *c, hv_uint32_t receiverHash, double delayMs, HvMessage *m);
 
+/**
+ * Sends a batch of messages, e.g. a burst of OSC or MIDI input. Each entry is a receiver hash,
+ * a delay and a message that the host has already built, for instance once with hv_msg_init()
+ * and then only updated. The input queue is locked once for the whole batch, and the messages
+ * only become visible to the audio thread together.
+ * This function is thread-safe.
+ *
+ * @return  The number of messages that were accepted, in order. It is less than the size of the
+ *          batch if the message queue filled up.
+ */
+int hv_sendMessages(HeavyContextInterface *c, const HvMessageBatch *batch);
+
 /**
  * Cancels a previously scheduled message.
  *
@@ -206,6 +231,17 @@ bool hv_sendMessageToReceiver(HeavyContextInterface *c, hv_uint32_t receiverHash
  */
 void hv_cancelMessage(HeavyContextInterface *c, HvMessage *m, void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *));
 
+/**
+ * Enables or disables latest-value delivery for a receiver, e.g. one that is sent automation.
+ * While it is enabled, floats sent to the receiver without a delay replace any value that has not
+ * been delivered yet, and only the newest is passed on at the start of the next block.
+ * Messages to all other receivers are queued and delivered in order as usual.
+ * This function is NOT thread-safe. It must not be called while the context is being processed.
+ *
+ * @return  True if the mode of the receiver was changed.
+ */
+bool hv_setReceiverLatestValueOnly(HeavyContextInterface *c, hv_uint32_t receiverHash, bool enabled);
+
 /** Returns the read-only user-assigned name of this patch. */
 const char *hv_getName(HeavyContextInterface *c);
 
@@ -218,7 +254,11 @@ void *hv_getUserData(HeavyContextInterface *c);
 /** Returns the current patch time in milliseconds. This value may have rounding errors. */
 double hv_getCurrentTime(HeavyContextInterface *c);
 
-/** Returns the current patch time in samples. This value is always exact. */
+/**
+ * Returns the current patch time in samples. This value is always exact.
+ * It wraps around to 0 after 2^32 samples (about 24.8 hours at 48kHz), which the scheduler
+ * handles, so instances can run indefinitely.
+ */
 hv_uint32_t hv_getCurrentSample(HeavyContextInterface *c);
 
 /**
@@ -304,6 +344,78 @@ void hv_setOutputMessageQueueSize(HeavyContextInterface *c, hv_uint32_t outQueue
 */
 bool hv_getNextSentMessage(HeavyContextInterface *c, hv_uint32_t *destinationHash, HvMessage *outMsg, hv_uint32_t msgLength);
 
+/**
+ * Passes every message in the outgoing queue to the handler, then consumes it.
+ * The queue is locked once for the whole pass, so this is much cheaper than
+ * calling hv_getNextSentMessage() for each message. The message pointer is only
+ * valid during the call to the handler.
+ *
+ * @param c  A Heavy context.
+ * @param f  The function called with each sent message.
+ * @param userData  Passed to the handler.
+ *
+ * @return  The number of messages that were processed.
+ */
+int hv_processSentMessages(HeavyContextInterface *c, HvSentMessageHandler_t *f, void *userData);
+
+/**
+ * Set the size of the print message queue in kilobytes.
+ *
+ * If the size is positive, print messages are copied into the queue on the
+ * audio thread and only formatted and passed to the print hook when
+ * hv_processPrintMessages() is called. A size of 0 calls the print hook directly.
+ *
+ * @param c  A Heavy context.
+ * @param printQueueKb  Must be zero or positive.
+ */
+void hv_setPrintMessageQueueSize(HeavyContextInterface *c, hv_uint32_t printQueueKb);
+
+/**
+ * Formats up to maxMessages queued print messages and passes them to the print hook.
+ * Must not be called from the audio thread.
+ *
+ * @param c  A Heavy context.
+ * @param maxMessages  The maximum number of messages to process in this call.
+ *
+ * @return  The number of messages that were printed.
+ */
+int hv_processPrintMessages(HeavyContextInterface *c, int maxMessages);
+
+/**
+ * Returns the number of print messages that were dropped because the print
+ * queue was full, since the last call to this function.
+ */
+hv_uint32_t hv_getNumDroppedPrintMessages(HeavyContextInterface *c);
+
+/**
+ * Set the size of the table resize queues in kilobytes.
+ *
+ * If the size is positive, a table that receives a resize message does not allocate
+ * on the audio thread. Its new buffer is allocated and filled when hv_processTableResizes()
+ * is called, swapped in at the start of a later block, and the old buffer is freed by the
+ * call to hv_processTableResizes() after that. The table sends out its new size in the block
+ * in which the buffer is swapped in. If the queue is full, requests wait for room and are
+ * retried at the start of each block, so the audio thread never allocates or frees a buffer.
+ * A size of 0 resizes tables immediately.
+ *
+ * @param c  A Heavy context.
+ * @param resizeQueueKb  Must be zero or positive.
+ */
+void hv_setTableResizeQueueSize(HeavyContextInterface *c, hv_uint32_t resizeQueueKb);
+
+/**
+ * Prepares the buffers of tables that are waiting to be resized, and frees the buffers
+ * that resized tables no longer use. Also rebuilds the mip-maps of wavetables whose tables
+ * have a new buffer or length. Without a table resize queue, the new mip-maps are swapped in
+ * immediately, so this must then not run during processing.
+ * Must not be called from the audio thread, and only from one thread at a time.
+ *
+ * @param c  A Heavy context.
+ *
+ * @return  The number of new table buffers and mip-maps that were prepared.
+ */
+int hv_processTableResizes(HeavyContextInterface *c);
+
 
 
 #if HV_APPLE
@@ -345,7 +457,7 @@ void hv_msg_setFloat(HvMessage *m, int i, float f);
 /** Returns true of the indexed element is a symbol. False otherwise. Index is not bounds checked. */
 bool hv_msg_isSymbol(const HvMessage *const m, int i);
 
-/** Returns the indexed element as a symbol value. Index is not bounds checked. */
+/** Returns the indexed element as a symbol value. The string stays valid for the lifetime of the program. Index is not bounds checked. */
 const char *hv_msg_getSymbol(const HvMessage *const m, int i);
 
 /** Returns true of the indexed element is a hash. False otherwise. Index is not bounds checked. */
@@ -354,8 +466,11 @@ bool hv_msg_isHash(const HvMessage *const m, int i);
 /** Returns the indexed element as a hash value. Index is not bounds checked. */
 hv_uint32_t hv_msg_getHash(const HvMessage *const m, int i);
 
-/** Sets the indexed element to symbol value. Index is not bounds checked. */
-void hv_msg_setSymbol(HvMessage *m, int i, const char *s);
+/**
+ * Sets the indexed element to symbol value. The string is interned, so it does not need to outlive the message. Index is not bounds checked.
+ * Returns false if the symbol table is full, in which case the element is set to the hash of the string.
+ */
+bool hv_msg_setSymbol(HvMessage *m, int i, const char *s);
 
 /**
  * Returns true if the message has the given format, in number of elements and type. False otherwise.
@@ -392,6 +507,10 @@ void hv_msg_free(HvMessage *m);
  *
  * Existing contents are copied to the new table. Remaining space is cleared
  * if the table is longer than the original, truncated otherwise.
+ * The table is resized immediately, even if a table resize queue is set (see
+ * hv_setTableResizeQueueSize()), and a resize or a file that is in flight for the
+ * table is dropped. So this must neither run during processing nor at the same time as
+ * hv_processTableResizes().
  *
  * @param tableHash  The table identifier.
  * @param newSampleLength  The new length of the table, in samples. Must be positive.
@@ -400,6 +519,21 @@ void hv_msg_free(HvMessage *m);
  */
 bool hv_table_setLength(HeavyContextInterface *c, hv_uint32_t tableHash, hv_uint32_t newSampleLength);
 
+/**
+ * Replaces the buffer of the table with the samples of a file opened with hMap_open() (see HvMappedFile.h),
+ * without copying them. The file must stay open while the table uses it. The previous buffer is freed.
+ *
+ * If a table resize queue is set (see hv_setTableResizeQueueSize()), the samples are swapped in at the
+ * start of the next block, and this must be called from the thread that calls hv_processTableResizes().
+ * Otherwise the table changes immediately, as with hv_table_setLength().
+ *
+ * @param tableHash  The table identifier.
+ * @param m  The file.
+ *
+ * @return  False if the table could not be found or the resize queue is full. True otherwise.
+ */
+bool hv_table_setMappedFile(HeavyContextInterface *c, hv_uint32_t tableHash, const HvMappedFile *m);
+
 /** Returns a pointer to the raw buffer backing this table. DO NOT free it. */
 float *hv_table_getBuffer(HeavyContextInterface *c, hv_uint32_t tableHash);
 
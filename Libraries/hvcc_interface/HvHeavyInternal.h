@@ -19,14 +19,18 @@
 
 #include "HvHeavy.h"
 #include "HvUtils.h"
+#include "HvArena.h"
 #include "HvTable.h"
 #include "HvMessage.h"
+#include "HvMessageQueue.h"
 #include "HvMath.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct SignalWavetable;
+
 /**
  *
  */
@@ -44,6 +48,35 @@ HvMessage *hv_scheduleMessageForObject(HeavyContextInterface *c, const HvMessage
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
     int letIndex);
 
+/**
+ * Schedules a message like hv_scheduleMessageForObject(), and appends its queue node to the owner's
+ * list so that the object can find and cancel its pending messages without searching the queue.
+ */
+MessageNode *hv_scheduleOwnedMessageForObject(HeavyContextInterface *c, const HvMessage *m,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *),
+    int letIndex, MessageNodeList *owner);
+
+/** Removes a scheduled message from the queue in constant time, given its queue node. */
+void hv_cancelMessageNode(HeavyContextInterface *c, MessageNode *n);
+
+/**
+ * Copies a print message into the print queue, to be printed later from another thread.
+ * Returns false if the context has no print queue and the message should be printed immediately.
+ */
+bool hv_deferPrintMessage(HeavyContextInterface *c, const char *printName, const HvMessage *m);
+
+/**
+ * Asks the host thread for a new buffer for the table, which is swapped in at the start of a later block.
+ * Returns false if the context has no resize queue and the table should be resized immediately.
+ */
+bool hv_requestTableResize(HeavyContextInterface *c, HvTable *o, hv_uint32_t newLength);
+
+/**
+ * Adds a wavetable to the context, whose mip-maps are rebuilt by hv_processTableResizes() when its
+ * table changes. Called once by sWavetable_init().
+ */
+void hv_addWavetable(HeavyContextInterface *c, struct SignalWavetable *o);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,28 +15,7 @@
  */
 
 #include "HvLightPipe.h"
-
-#if __SSE__ || HV_SIMD_SSE
-#include <xmmintrin.h>
-#define hv_sfence() _mm_sfence()
-#elif __arm__ || HV_SIMD_NEON
-  #if __ARM_ACLE
-    #include <arm_acle.h>
-    // https://msdn.microsoft.com/en-us/library/hh875058.aspx#BarrierRestrictions
-    // http://doxygen.reactos.org/d8/d47/armintr_8h_a02be7ec76ca51842bc90d9b466b54752.html
-    #define hv_sfence() __dmb(0xE) /* _ARM_BARRIER_ST */
-  #elif defined(__GNUC__)
-    #define hv_sfence() __asm__ volatile ("dmb 0xE":::"memory")
-  #else
-    // http://stackoverflow.com/questions/19965076/gcc-memory-barrier-sync-synchronize-vs-asm-volatile-memory
-    #define hv_sfence() __sync_synchronize()
-  #endif
-#elif HV_WIN
-// https://msdn.microsoft.com/en-us/library/windows/desktop/ms684208(v=vs.85).aspx
-#define hv_sfence() _WriteBarrier()
-#else
-#define hv_sfence() __asm__ volatile("" : : : "memory")
-#endif
+#include "HvArena.h"
 
 #define HLP_STOP 0
 #define HLP_LOOP 0xFFFFFFFF
@@ -45,7 +24,7 @@
 
 hv_uint32_t hLp_init(HvLightPipe *q, hv_uint32_t numBytes) {
   if (numBytes > 0) {
-    q->buffer = (char *) hv_malloc(numBytes);
+    q->buffer = (char *) hv_arena_malloc(numBytes);
     hv_assert(q->buffer != NULL);
     HLP_SET_UINT32_AT_BUFFER(q->buffer, HLP_STOP);
   } else {
@@ -59,7 +38,7 @@ hv_uint32_t hLp_init(HvLightPipe *q, hv_uint32_t numBytes) {
 }
 
 void hLp_free(HvLightPipe *q) {
-  hv_free(q->buffer);
+  hv_arena_free(q->buffer);
 }
 
 hv_uint32_t hLp_hasData(HvLightPipe *q) {
@@ -117,6 +96,25 @@ void hLp_produce(HvLightPipe *q, hv_uint32_t numBytes) {
   HLP_SET_UINT32_AT_BUFFER(oldWriteHead, numBytes);
 }
 
+char *hLp_produceHidden(HvLightPipe *q, hv_uint32_t numBytes) {
+  hv_assert(q->remainingBytes >= (numBytes + 2*sizeof(hv_uint32_t)));
+  q->remainingBytes -= (sizeof(hv_uint32_t) + numBytes);
+  char *const oldWriteHead = q->writeHead;
+  q->writeHead += (sizeof(hv_uint32_t) + numBytes);
+
+  // the old write head still reads HLP_STOP, so the consumer cannot get past it
+  HLP_SET_UINT32_AT_BUFFER(q->writeHead, HLP_STOP);
+  return oldWriteHead;
+}
+
+void hLp_publish(HvLightPipe *q, char *entry, hv_uint32_t numBytes) {
+  // save everything that was produced since the entry to memory
+  hv_sfence();
+
+  // then release all of it
+  HLP_SET_UINT32_AT_BUFFER(entry, numBytes);
+}
+
 char *hLp_getReadBuffer(HvLightPipe *q, hv_uint32_t *numBytes) {
   *numBytes = HLP_GET_UINT32_AT_BUFFER(q->readHead);
   char *const readBuffer = q->readHead + sizeof(hv_uint32_t);
@@ -76,6 +76,21 @@ char *hLp_getWriteBuffer(HvLightPipe *q, hv_uint32_t numBytes);
  */
 void hLp_produce(HvLightPipe *q, hv_uint32_t numBytes);
 
+/**
+ * Like hLp_produce(), but the data is not visible to the consumer until hLp_publish() is called.
+ * Everything produced after it stays hidden as well, so several writes can be made visible at once.
+ *
+ * @return  The hidden entry, to be passed to hLp_publish().
+ */
+char *hLp_produceHidden(HvLightPipe *q, hv_uint32_t numBytes);
+
+/**
+ * Makes an entry from hLp_produceHidden(), and everything produced after it, visible to the consumer.
+ *
+ * @param numBytes  The same value as was passed to hLp_produceHidden().
+ */
+void hLp_publish(HvLightPipe *q, char *entry, hv_uint32_t numBytes);
+
 /**
  * Returns the current read buffer, indicating the number of bytes available
  * for reading.
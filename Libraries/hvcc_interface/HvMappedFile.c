@@ -0,0 +1,270 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "HvMappedFile.h"
+#include "HvTable.h"
+
+#if !HV_WIN
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+// samples are aligned for the aligned loads of __hv_tabread_f with any SIMD width
+#define HV_MAP_ALIGNMENT 32
+
+// the number of samples that are read ahead when a file is opened
+#define HV_MAP_PREFETCH_SAMPLES 65536
+
+// leaves room for the padding of the table
+#define HV_MAP_MAX_SAMPLES (0xFFFFFFFF - 2*HV_MAP_ALIGNMENT)
+
+typedef struct HvFileReader {
+#if HV_WIN
+  FILE *f;
+#else
+  int fd;
+#endif
+  hv_uint64_t numBytes;
+} HvFileReader;
+
+typedef struct HvSampleFormat {
+  hv_uint64_t dataOffset; // in bytes from the start of the file
+  hv_uint64_t dataBytes;
+  hv_uint32_t numChannels;
+  hv_uint32_t bytesPerSample;
+  bool isFloat;
+} HvSampleFormat;
+
+static bool hMap_openReader(HvFileReader *r, const char *path) {
+#if HV_WIN
+  r->f = fopen(path, "rb");
+  if (r->f == NULL) return false;
+  _fseeki64(r->f, 0, SEEK_END);
+  r->numBytes = (hv_uint64_t) _ftelli64(r->f);
+#else
+  r->fd = open(path, O_RDONLY);
+  if (r->fd < 0) return false;
+  struct stat s;
+  if (fstat(r->fd, &s) != 0) {
+    close(r->fd);
+    return false;
+  }
+  r->numBytes = (hv_uint64_t) s.st_size;
+#endif
+  return true;
+}
+
+static bool hMap_read(HvFileReader *r, hv_uint64_t offset, void *dst, hv_size_t numBytes) {
+#if HV_WIN
+  return (_fseeki64(r->f, (__int64) offset, SEEK_SET) == 0) && (fread(dst, 1, numBytes, r->f) == numBytes);
+#else
+  char *c = (char *) dst;
+  while (numBytes > 0) {
+    const ssize_t n = pread(r->fd, c, numBytes, (off_t) offset);
+    if (n <= 0) return false;
+    c += n;
+    offset += (hv_uint64_t) n;
+    numBytes -= (hv_size_t) n;
+  }
+  return true;
+#endif
+}
+
+static void hMap_closeReader(HvFileReader *r) {
+#if HV_WIN
+  fclose(r->f);
+#else
+  close(r->fd);
+#endif
+}
+
+// WAV files are little-endian
+static inline hv_uint32_t hMap_le16(const unsigned char *b) {
+  return ((hv_uint32_t) b[0]) | (((hv_uint32_t) b[1]) << 8);
+}
+
+static inline hv_uint32_t hMap_le32(const unsigned char *b) {
+  return hMap_le16(b) | (hMap_le16(b+2) << 16);
+}
+
+static bool hMap_parseFormat(HvFileReader *r, HvSampleFormat *f) {
+  unsigned char h[26];
+  if ((r->numBytes < 12) || !hMap_read(r, 0, h, 12) || memcmp(h, "RIFF", 4) || memcmp(h+8, "WAVE", 4)) {
+    // anything that is not a WAV file is read as raw 32-bit floats
+    f->dataOffset = 0;
+    f->dataBytes = r->numBytes;
+    f->numChannels = 1;
+    f->bytesPerSample = 4;
+    f->isFloat = true;
+    return true;
+  }
+
+  bool hasFormat = false;
+  hv_uint64_t offset = 12;
+  while (offset + 8 <= r->numBytes) {
+    if (!hMap_read(r, offset, h, 8)) return false;
+    const hv_uint32_t chunkBytes = hMap_le32(h+4);
+    if (!memcmp(h, "fmt ", 4) && (chunkBytes >= 16)) {
+      const hv_size_t n = (chunkBytes >= 26) ? 26 : 16;
+      if (!hMap_read(r, offset+8, h, n)) return false;
+      hv_uint32_t formatTag = hMap_le16(h);
+      if ((formatTag == 0xFFFE) && (n == 26)) formatTag = hMap_le16(h+24); // WAVE_FORMAT_EXTENSIBLE
+      f->numChannels = hMap_le16(h+2);
+      f->bytesPerSample = hMap_le16(h+14) / 8;
+      f->isFloat = (formatTag == 3);
+      if ((formatTag != 1) && (formatTag != 3)) return false; // only PCM and IEEE float
+      if (f->isFloat ? (f->bytesPerSample != 4) : (f->bytesPerSample < 2 || f->bytesPerSample > 4)) return false;
+      if (f->numChannels == 0) return false;
+      hasFormat = true;
+    } else if (!memcmp(h, "data", 4)) {
+      if (!hasFormat) return false;
+      f->dataOffset = offset + 8;
+      // the size may be too large if the file was not finalised
+      f->dataBytes = r->numBytes - f->dataOffset;
+      if (chunkBytes < f->dataBytes) f->dataBytes = chunkBytes;
+      return true;
+    }
+    offset += 8 + chunkBytes + (chunkBytes & 0x1); // chunks are padded to an even size
+  }
+  return false;
+}
+
+static inline float hMap_decodeSample(const unsigned char *b, const HvSampleFormat *f) {
+  switch (f->bytesPerSample) {
+    case 2: return ((float) (hv_int16_t) hMap_le16(b)) / 32768.0f;
+    case 3: return ((float) (((hv_int32_t) ((hMap_le16(b) << 8) | (((hv_uint32_t) b[2]) << 24))) >> 8)) / 8388608.0f;
+    default: {
+      if (f->isFloat) {
+        float x;
+        hv_memcpy(&x, b, sizeof(float));
+        return x;
+      }
+      return ((float) (hv_int32_t) hMap_le32(b)) / 2147483648.0f;
+    }
+  }
+}
+
+static bool hMap_copySamples(HvMappedFile *m, HvFileReader *r, const HvSampleFormat *f, hv_size_t tableBytes) {
+  m->numBytes = (tableBytes + HV_MAP_ALIGNMENT-1) & ~((hv_size_t) HV_MAP_ALIGNMENT-1);
+  m->base = (char *) hv_malloc(m->numBytes);
+  if (m->base == NULL) return false;
+  hv_memclear(m->base, m->numBytes);
+  m->samples = (float *) m->base;
+  m->mapped = false;
+
+  // read a few frames at a time and keep the first channel
+  unsigned char chunk[16*1024];
+  const hv_uint32_t frameBytes = f->numChannels * f->bytesPerSample;
+  const hv_uint32_t framesPerChunk = (hv_uint32_t) (sizeof(chunk) / frameBytes);
+  if (framesPerChunk == 0) return false;
+  for (hv_uint32_t i = 0; i < m->numSamples; i += framesPerChunk) {
+    const hv_uint32_t n = hv_min_ui(framesPerChunk, m->numSamples - i);
+    if (!hMap_read(r, f->dataOffset + ((hv_uint64_t) i) * frameBytes, chunk, n * frameBytes)) return false;
+    for (hv_uint32_t j = 0; j < n; ++j) {
+      m->samples[i+j] = hMap_decodeSample(chunk + j*frameBytes, f);
+    }
+  }
+  return true;
+}
+
+#if !HV_WIN
+static bool hMap_mapSamples(HvMappedFile *m, HvFileReader *r, const HvSampleFormat *f, hv_size_t tableBytes) {
+  const hv_uint64_t pageBytes = (hv_uint64_t) sysconf(_SC_PAGESIZE);
+  const hv_uint64_t fileOffset = f->dataOffset & ~(pageBytes-1); // mappings start on a page
+  const hv_size_t headerBytes = (hv_size_t) (f->dataOffset - fileOffset);
+  m->numBytes = (hv_size_t) ((headerBytes + tableBytes + pageBytes-1) & ~(pageBytes-1));
+
+  // reserve zeroed memory for the whole table first, so that reading its padding never touches
+  // pages past the end of the file
+  void *p = mmap(NULL, m->numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) return false;
+  const hv_uint64_t fileBytes = (r->numBytes - fileOffset + pageBytes-1) & ~(pageBytes-1);
+  const hv_size_t mappedFileBytes = (fileBytes < m->numBytes) ? (hv_size_t) fileBytes : m->numBytes;
+  if (mmap(p, mappedFileBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, r->fd, (off_t) fileOffset) == MAP_FAILED) {
+    munmap(p, m->numBytes);
+    return false;
+  }
+  m->base = (char *) p;
+  m->samples = (float *) (m->base + headerBytes);
+  m->mapped = true;
+
+  // anything that follows the samples in the file must read as silence. Only the last page is copied.
+  hv_memclear(m->samples + m->numSamples, tableBytes - m->numSamples*sizeof(float));
+
+#ifdef MADV_WILLNEED
+  madvise(m->base, hv_min_ui(m->numBytes, HV_MAP_PREFETCH_SAMPLES*sizeof(float)), MADV_WILLNEED);
+#endif
+  return true;
+}
+#endif
+
+HvMappedFile *hMap_open(const char *path) {
+  HvFileReader r;
+  if (!hMap_openReader(&r, path)) return NULL;
+
+  HvMappedFile *m = NULL;
+  HvSampleFormat f;
+  if (hMap_parseFormat(&r, &f)) {
+    const hv_uint64_t numFrames = f.dataBytes / (f.numChannels * f.bytesPerSample);
+    if (numFrames <= HV_MAP_MAX_SAMPLES) {
+      m = (HvMappedFile *) hv_malloc((sizeof(HvMappedFile) + 31) & ~((hv_size_t) 31));
+      hv_assert(m != NULL);
+      m->numSamples = (hv_uint32_t) numFrames;
+      // a table of this length also reads the padding after its samples
+      const hv_size_t tableBytes = (hTable_sizeForLength(m->numSamples) + HV_N_SIMD) * sizeof(float);
+      bool loaded = false;
+#if !HV_WIN
+      // samples can be used in place if they need no conversion and their offset in the file is aligned
+      if (f.isFloat && (f.numChannels == 1) && ((f.dataOffset & (HV_MAP_ALIGNMENT-1)) == 0)) {
+        loaded = hMap_mapSamples(m, &r, &f, tableBytes);
+      }
+#endif
+      if (!loaded) {
+        loaded = hMap_copySamples(m, &r, &f, tableBytes);
+        if (!loaded) hv_free(m->base);
+      }
+      if (!loaded) {
+        hv_free(m);
+        m = NULL;
+      }
+    }
+  }
+  hMap_closeReader(&r);
+  return m;
+}
+
+void hMap_close(HvMappedFile *m) {
+  if (m == NULL) return;
+
+#if !HV_WIN
+  if (m->mapped) munmap(m->base, m->numBytes);
+  else
+#endif
+  hv_free(m->base);
+  hv_free(m);
+}
+
+void hMap_prefetch(const HvMappedFile *m, hv_uint32_t firstSample, hv_uint32_t numSamples) {
+#if !HV_WIN && defined(MADV_WILLNEED)
+  if (!m->mapped || (firstSample >= m->numSamples)) return; // copied samples are already in memory
+  const hv_uintptr_t pageBytes = (hv_uintptr_t) sysconf(_SC_PAGESIZE);
+  const hv_uintptr_t start = ((hv_uintptr_t) (m->samples + firstSample)) & ~(pageBytes-1);
+  const hv_uintptr_t end = (hv_uintptr_t) (m->samples + firstSample + hv_min_ui(numSamples, m->numSamples - firstSample));
+  madvise((void *) start, (hv_size_t) (end - start), MADV_WILLNEED);
+#endif
+}
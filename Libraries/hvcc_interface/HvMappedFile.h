@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _HEAVY_MAPPED_FILE_H_
+#define _HEAVY_MAPPED_FILE_H_
+
+#include "HvUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HvMappedFile {
+  char *base; // the start of the whole region, which is page aligned
+  hv_size_t numBytes; // the size of the whole region
+  float *samples; // the first sample, aligned for SIMD access
+  hv_uint32_t numSamples;
+  bool mapped; // the samples are mapped from the file rather than copied to the heap
+} HvMappedFile;
+
+/**
+ * An HvMappedFile holds sample data that can back a Heavy table without being copied into it
+ * (see hv_table_setMappedFile()). Raw 32-bit float files and mono 32-bit float WAV files are
+ * mapped directly from the file, so they load without reading the whole file and their pages
+ * are shared through the page cache by every instance that maps them. Pages are read from disk
+ * as they are first touched. Other WAV files (16, 24 or 32-bit PCM, more than one channel) and
+ * all files on Windows are read into a heap buffer instead. Only the first channel is kept.
+ *
+ * The samples are followed by enough zeros to satisfy the size and alignment of a table.
+ * The region is private: writing to it (e.g. with tabwrite~) copies the touched pages and
+ * never changes the file.
+ */
+
+/**
+ * Opens a raw float or WAV file.
+ * @return  Returns the file, or NULL if it could not be read or its format is not supported.
+ */
+HvMappedFile *hMap_open(const char *path);
+
+/** Releases the file. Tables must no longer use it. */
+void hMap_close(HvMappedFile *m);
+
+/**
+ * Asks the system to read the given range of samples from disk ahead of time, so that the audio
+ * thread does not wait for it. Does not block. Should be called from a host thread some time
+ * before the samples are played, e.g. ahead of the read head of a streaming tabread~.
+ */
+void hMap_prefetch(const HvMappedFile *m, hv_uint32_t firstSample, hv_uint32_t numSamples);
+
+static inline float *hMap_getSamples(const HvMappedFile *m) {
+  return m->samples;
+}
+
+static inline hv_uint32_t hMap_getNumSamples(const HvMappedFile *m) {
+  return m->numSamples;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HEAVY_MAPPED_FILE_H_
@@ -73,7 +73,23 @@ static inline void __hv_store_f(float *bOut, hv_bInf_t bIn) {
 
 static inline void __hv_log2_f(hv_bInf_t bIn, hv_bOutf_t bOut) {
 #if HV_SIMD_AVX
-  hv_assert(0); // __hv_log2_f() not implemented
+  // the same approximation as the SSE version, the integer operations are done on each half
+  // unless AVX2 is available
+  __m256i a = _mm256_castps_si256(bIn);
+#if __AVX2__
+  __m256i c = _mm256_sub_epi32(_mm256_srli_epi32(a, 23), _mm256_set1_epi32(127)); // exponent (int)
+#else
+  __m128i c0 = _mm_sub_epi32(_mm_srli_epi32(_mm256_castsi256_si128(a), 23), _mm_set1_epi32(127));
+  __m128i c1 = _mm_sub_epi32(_mm_srli_epi32(_mm256_extractf128_si256(a, 1), 23), _mm_set1_epi32(127));
+  __m256i c = _mm256_insertf128_si256(_mm256_castsi128_si256(c0), c1, 1); // exponent (int)
+#endif // __AVX2__
+  __m256 d = _mm256_cvtepi32_ps(c); // exponent (float)
+  __m256 f = _mm256_or_ps(_mm256_andnot_ps(
+      _mm256_castsi256_ps(_mm256_set1_epi32(0xFF800000)), bIn),
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x3F800000))); // 1+m (float)
+  __m256 g = _mm256_add_ps(d, f); // e + 1 + m
+  __m256 h = _mm256_add_ps(g, _mm256_set1_ps(-0.9569643f)); // e + 1 + m + (sigma-1)
+  *bOut = h;
 #elif HV_SIMD_SSE
   // https://en.wikipedia.org/wiki/Fast_inverse_square_root
   __m128i a = _mm_castps_si128(bIn);
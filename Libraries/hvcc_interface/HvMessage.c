@@ -42,7 +42,7 @@ HvMessage *msg_initWithBang(HvMessage *m, hv_uint32_t timestamp) {
 HvMessage *msg_initWithSymbol(HvMessage *m, hv_uint32_t timestamp, const char *s) {
   m->timestamp = timestamp;
   m->numElements = 1;
-  m->numBytes = sizeof(HvMessage) + (hv_uint16_t) hv_strlen(s);
+  m->numBytes = sizeof(HvMessage);
   msg_setSymbol(m, 0, s);
   return m;
 }
@@ -58,30 +58,19 @@ HvMessage *msg_initWithHash(HvMessage *m, hv_uint32_t timestamp, hv_uint32_t h)
 void msg_copyToBuffer(const HvMessage *m, char *buffer, hv_size_t len) {
   HvMessage *r = (HvMessage *) buffer;
 
-  hv_size_t len_r = msg_getCoreSize(msg_getNumElements(m));
+  const hv_size_t len_r = msg_getCoreSize(msg_getNumElements(m));
 
   // assert that the message is not already larger than the length of the buffer
   hv_assert(len_r <= len);
 
-  // copy the basic message to the buffer
-  hv_memcpy(r, m, len_r);
-
-  char *p = buffer + len_r; // points to the end of the base message
-  for (int i = 0; i < msg_getNumElements(m); ++i) {
-    if (msg_isSymbol(m,i)) {
-      const hv_size_t symLen = (hv_size_t) hv_strlen(msg_getSymbol(m,i)) + 1; // include the trailing null char
-      hv_assert(len_r + symLen <= len); // stay safe!
-      hv_strncpy(p, msg_getSymbol(m,i), symLen);
-      msg_setSymbol(r, i, p);
-      p += symLen;
-      len_r += symLen;
-    }
-  }
-
-  r->numBytes = (hv_uint16_t) len_r; // update the message size in memory
+  // symbols are interned, so the elements can be copied as they are. Views are copied from the
+  // elements that they refer to, and become ordinary messages.
+  r->timestamp = m->timestamp;
+  r->numElements = m->numElements;
+  r->numBytes = (hv_uint16_t) len_r;
+  hv_memcpy(&r->elem, msg_getElements(m), msg_getNumElements(m)*sizeof(Element));
 }
 
-// the message is serialised such that all symbol elements are placed in order at the end of the buffer
 HvMessage *msg_copy(const HvMessage *m) {
   const hv_uint32_t heapSize = msg_getSize(m);
   char *r = (char *) hv_malloc(heapSize);
@@ -111,7 +100,8 @@ bool msg_hasFormat(const HvMessage *m, const char *fmt) {
 
 bool msg_compareSymbol(const HvMessage *m, int i, const char *s) {
   switch (msg_getType(m,i)) {
-    case HV_MSG_SYMBOL: return !hv_strcmp(msg_getSymbol(m, i), s);
+    // a string that was never interned cannot be in any message
+    case HV_MSG_SYMBOL: return msg_getSymbolId(m, i) == hSymbol_find(s);
     case HV_MSG_HASH: return (msg_getHash(m,i) == hv_string_to_hash(s));
     default: return false;
   }
@@ -123,7 +113,7 @@ bool msg_equalsElement(const HvMessage *m, int i_m, const HvMessage *n, int i_n)
       switch (msg_getType(m, i_m)) {
         case HV_MSG_BANG: return true;
         case HV_MSG_FLOAT: return (msg_getFloat(m, i_m) == msg_getFloat(n, i_n));
-        case HV_MSG_SYMBOL: return msg_compareSymbol(m, i_m, msg_getSymbol(n, i_n));
+        case HV_MSG_SYMBOL: return msg_getSymbolId(m, i_m) == msg_getSymbolId(n, i_n);
         case HV_MSG_HASH: return msg_getHash(m,i_m) == msg_getHash(n,i_n);
         default: break;
       }
@@ -136,7 +126,7 @@ void msg_setElementToFrom(HvMessage *n, int i_n, const HvMessage *const m, int i
   switch (msg_getType(m, i_m)) {
     case HV_MSG_BANG: msg_setBang(n, i_n); break;
     case HV_MSG_FLOAT: msg_setFloat(n, i_n, msg_getFloat(m, i_m)); break;
-    case HV_MSG_SYMBOL: msg_setSymbol(n, i_n, msg_getSymbol(m, i_m)); break;
+    case HV_MSG_SYMBOL: msg_setSymbolId(n, i_n, msg_getSymbolId(m, i_m)); break;
     case HV_MSG_HASH: msg_setHash(n, i_n, msg_getHash(m, i_m));
     default: break;
   }
@@ -150,8 +140,8 @@ hv_uint32_t msg_getHash(const HvMessage *const m, int i) {
       float f = msg_getFloat(m,i);
       return *((hv_uint32_t *) &f);
     }
-    case HV_MSG_SYMBOL: return hv_string_to_hash(msg_getSymbol(m,i));
-    case HV_MSG_HASH: return (&(m->elem)+i)->data.h;
+    case HV_MSG_SYMBOL: return hSymbol_getHash(msg_getSymbolId(m,i));
+    case HV_MSG_HASH: return (msg_getElements(m)+i)->data.h;
     default: return 0;
   }
 }
@@ -18,6 +18,7 @@
 #define _HEAVY_MESSAGE_H_
 
 #include "HvUtils.h"
+#include "HvSymbol.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,11 +31,12 @@ typedef enum ElementType {
   HV_MSG_HASH = 3
 } ElementType;
 
+// 8 bytes on all platforms, symbols are stored by their interned id rather than by pointer
 typedef struct Element {
-  ElementType type;
+  hv_uint32_t type; // ElementType
   union {
     float f; // float
-    const char *s; // symbol
+    hv_uint32_t s; // symbol id
     hv_uint32_t h; // hash
   } data;
 } Element;
@@ -42,10 +44,23 @@ typedef struct Element {
 typedef struct HvMessage {
   hv_uint32_t timestamp; // the sample at which this message should be processed
   hv_uint16_t numElements;
-  hv_uint16_t numBytes; // the total number of bytes that this message occupies in memory, including strings
+  hv_uint16_t numBytes; // the total number of bytes that this message occupies in memory
   Element elem;
 } HvMessage;
 
+/**
+ * A read-only view onto a run of elements in another message. A view can be passed anywhere a
+ * const HvMessage * is expected, which lets objects such as [slice] forward part of a message
+ * without copying it. It is only copied into a real message when it is scheduled or queued.
+ * Views are marked by numBytes being 0, and must not outlive the message that they view.
+ */
+typedef struct HvMessageView {
+  hv_uint32_t timestamp;
+  hv_uint16_t numElements;
+  hv_uint16_t numBytes; // always 0
+  const Element *elem; // the first element in view
+} HvMessageView;
+
 typedef struct ReceiverMessagePair {
   hv_uint32_t receiverHash;
   HvMessage msg;
@@ -53,15 +68,38 @@ typedef struct ReceiverMessagePair {
 
 #define HV_MESSAGE_ON_STACK(_x) (HvMessage *) hv_alloca(msg_getCoreSize(_x))
 
-/** Returns the number of bytes that this message consumes in memory, not including strings. */
+/** Returns the number of bytes that this message consumes in memory. Symbols are interned, so this is all of it. */
 static inline hv_size_t msg_getCoreSize(hv_size_t numElements) {
   hv_assert(numElements > 0);
   return sizeof(HvMessage) + ((numElements-1) * sizeof(Element));
 }
 
+static inline bool msg_isView(const HvMessage *m) {
+  return m->numBytes == 0;
+}
+
+/** Returns the elements of the message, wherever they are stored. */
+static inline const Element *msg_getElements(const HvMessage *m) {
+  return msg_isView(m) ? ((const HvMessageView *) m)->elem : &m->elem;
+}
+
+/**
+ * Initialises a view onto numElements elements of m, starting at index offset. The returned message
+ * is valid for as long as both v and m are.
+ */
+static inline const HvMessage *msg_initView(HvMessageView *v, const HvMessage *m, int offset, int numElements,
+    hv_uint32_t timestamp) {
+  hv_assert(numElements > 0 && offset + numElements <= (int) m->numElements); // invalid range
+  v->timestamp = timestamp;
+  v->numElements = (hv_uint16_t) numElements;
+  v->numBytes = 0;
+  v->elem = msg_getElements(m) + offset; // views of views refer directly to the original elements
+  return (const HvMessage *) v;
+}
+
 HvMessage *msg_copy(const HvMessage *m);
 
-/** Copies the message into the given buffer. The buffer must be at least as large as msg_getNumHeapBytes(). */
+/** Copies the message into the given buffer. The buffer must be at least as large as msg_getSize(). */
 void msg_copyToBuffer(const HvMessage *m, char *buffer, hv_size_t len);
 
 void msg_setElementToFrom(HvMessage *n, int indexN, const HvMessage *const m, int indexM);
@@ -87,24 +125,34 @@ static inline void msg_setTimestamp(HvMessage *m, hv_uint32_t timestamp) {
   m->timestamp = timestamp;
 }
 
+/**
+ * Returns true if timestamp a occurs before timestamp b. The sample clock is 32 bits wide and wraps
+ * around (after about a day at 48kHz), so timestamps must never be compared with < directly. This
+ * holds for any two timestamps that are less than 2^31 samples (about 12 hours at 48kHz) apart.
+ */
+static inline bool msg_isTimestampBefore(hv_uint32_t a, hv_uint32_t b) {
+  return (hv_int32_t) (a - b) < 0;
+}
+
 static inline int msg_getNumElements(const HvMessage *m) {
   return (int) m->numElements;
 }
 
-/** Returns the total number of bytes this message consumes in memory. */
+/** Returns the total number of bytes this message consumes in memory, or would once copied if it is a view. */
 static inline hv_uint32_t msg_getSize(const HvMessage *m) {
-  return m->numBytes;
+  return msg_isView(m) ? (hv_uint32_t) msg_getCoreSize(m->numElements) : m->numBytes;
 }
 
 static inline ElementType msg_getType(const HvMessage *m, int index) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
-  return (&(m->elem)+index)->type;
+  return (ElementType) (msg_getElements(m)+index)->type;
 }
 
 static inline void msg_setBang(HvMessage *m, int index) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
+  hv_assert(!msg_isView(m)); // views are read-only
   (&(m->elem)+index)->type = HV_MSG_BANG;
-  (&(m->elem)+index)->data.s = NULL;
+  (&(m->elem)+index)->data.h = 0;
 }
 
 static inline bool msg_isBang(const HvMessage *m, int index) {
@@ -113,13 +161,14 @@ static inline bool msg_isBang(const HvMessage *m, int index) {
 
 static inline void msg_setFloat(HvMessage *m, int index, float f) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
+  hv_assert(!msg_isView(m)); // views are read-only
   (&(m->elem)+index)->type = HV_MSG_FLOAT;
   (&(m->elem)+index)->data.f = f;
 }
 
 static inline float msg_getFloat(const HvMessage *const m, int index) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
-  return (&(m->elem)+index)->data.f;
+  return (msg_getElements(m)+index)->data.f;
 }
 
 static inline bool msg_isFloat(const HvMessage *const m, int index) {
@@ -128,6 +177,7 @@ static inline bool msg_isFloat(const HvMessage *const m, int index) {
 
 static inline void msg_setHash(HvMessage *m, int index, hv_uint32_t h) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
+  hv_assert(!msg_isView(m)); // views are read-only
   (&(m->elem)+index)->type = HV_MSG_HASH;
   (&(m->elem)+index)->data.h = h;
 }
@@ -144,27 +194,64 @@ static inline bool msg_isHashLike(const HvMessage *m, int index) {
 /** Returns a 32-bit hash of the given element. */
 hv_uint32_t msg_getHash(const HvMessage *const m, int i);
 
-static inline void msg_setSymbol(HvMessage *m, int index, const char *s) {
+/** Sets a symbol by its interned id, e.g. one taken from another message. */
+static inline void msg_setSymbolId(HvMessage *m, int index, hv_uint32_t id) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
-  hv_assert(s != NULL);
+  hv_assert(!msg_isView(m)); // views are read-only
+  hv_assert(id != HV_SYMBOL_NONE);
   (&(m->elem)+index)->type = HV_MSG_SYMBOL;
-  (&(m->elem)+index)->data.s = s;
-  // NOTE(mhroth): if the same message container is reused and string reset,
-  // then the message size will be overcounted
-  m->numBytes += (hv_uint16_t) (hv_strlen(s) + 1); // also count '\0'
+  (&(m->elem)+index)->data.s = id;
 }
 
-static inline const char *msg_getSymbol(const HvMessage *m, int index) {
+/**
+ * Sets a symbol from a string. This hashes the string, and the first use of a string takes a lock and
+ * allocates memory, so while processing use msg_setBuiltinSymbol() or msg_setSymbolId() instead.
+ * @return  False if the symbol table is full. The element is then the hash of the string, which still
+ *          matches receivers and switches, but has no name.
+ */
+static inline bool msg_setSymbol(HvMessage *m, int index, const char *s) {
+  const hv_uint32_t id = hSymbol_intern(s);
+  if (id != HV_SYMBOL_NONE) msg_setSymbolId(m, index, id);
+  else msg_setHash(m, index, hv_string_to_hash(s));
+  return (id != HV_SYMBOL_NONE);
+}
+
+static inline void msg_setBuiltinSymbol(HvMessage *m, int index, HvBuiltinSymbol id) {
+  msg_setSymbolId(m, index, (hv_uint32_t) id);
+}
+
+static inline hv_uint32_t msg_getSymbolId(const HvMessage *m, int index) {
   hv_assert(index < msg_getNumElements(m)); // invalid index
-  return (&(m->elem)+index)->data.s;
+  return (msg_getElements(m)+index)->data.s;
+}
+
+static inline const char *msg_getSymbol(const HvMessage *m, int index) {
+  return hSymbol_getName(msg_getSymbolId(m, index));
 }
 
 static inline bool msg_isSymbol(const HvMessage *m, int index) {
   return (index < msg_getNumElements(m)) ? (msg_getType(m, index) == HV_MSG_SYMBOL) : false;
 }
 
+/**
+ * Returns true if the element is the given string, or its hash. This hashes the string, so while
+ * processing use msg_compareBuiltinSymbol() or msg_compareSymbolId() instead.
+ */
 bool msg_compareSymbol(const HvMessage *m, int i, const char *s);
 
+/** Returns true if the element is the symbol with the given id, or its hash. Does not look at any strings. */
+static inline bool msg_compareSymbolId(const HvMessage *m, int i, hv_uint32_t id) {
+  switch (msg_getType(m,i)) {
+    case HV_MSG_SYMBOL: return msg_getSymbolId(m, i) == id;
+    case HV_MSG_HASH: return (msg_getElements(m)+i)->data.h == hSymbol_getHash(id);
+    default: return false;
+  }
+}
+
+static inline bool msg_compareBuiltinSymbol(const HvMessage *m, int i, HvBuiltinSymbol id) {
+  return msg_compareSymbolId(m, i, (hv_uint32_t) id);
+}
+
 /** Returns 1 if the element i_m of message m is equal to element i_n of message n. */
 bool msg_equalsElement(const HvMessage *m, int i_m, const HvMessage *n, int i_n);
 
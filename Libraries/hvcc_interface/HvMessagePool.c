@@ -16,6 +16,7 @@
 
 #include "HvMessagePool.h"
 #include "HvMessage.h"
+#include "HvArena.h"
 
 // the number of bytes reserved at a time from the pool
 #define MP_BLOCK_SIZE_BYTES 512
@@ -24,8 +25,8 @@
 #pragma mark - MessageList
 #endif
 
+// a free chunk holds the link to the next free chunk of its list, so the lists never allocate
 typedef struct MessageListNode {
-  char *p;
   struct MessageListNode *next;
 } MessageListNode;
 
@@ -36,78 +37,47 @@ static inline bool ml_hasAvailable(HvMessagePoolList *ml) {
 static char *ml_pop(HvMessagePoolList *ml) {
   MessageListNode *n = ml->head;
   ml->head = n->next;
-  n->next = ml->pool;
-  ml->pool = n;
-  char *const p = n->p;
-  n->p = NULL; // set to NULL to make it clear that this node does not have a valid buffer
-  return p;
+  return (char *) n;
 }
 
-/** Push a MessageListNode with the given pointer onto the head of the queue. */
+/** Push a free chunk onto the head of the list. */
 static void ml_push(HvMessagePoolList *ml, void *p) {
-  MessageListNode *n = NULL;
-  if (ml->pool != NULL) {
-    // take an empty MessageListNode from the pool
-    n = ml->pool;
-    ml->pool = n->next;
-  } else {
-    // a MessageListNode is not available, allocate one
-    n = (MessageListNode *) hv_malloc(sizeof(MessageListNode));
-    hv_assert(n != NULL);
-  }
-  n->p = (char *) p;
+  MessageListNode *n = (MessageListNode *) p;
   n->next = ml->head;
   ml->head = n; // push to the front of the queue
 }
 
-static void ml_free(HvMessagePoolList *ml) {
-  if (ml != NULL) {
-    while (ml_hasAvailable(ml)) {
-      ml_pop(ml);
-    }
-    while (ml->pool != NULL) {
-      MessageListNode *n = ml->pool;
-      ml->pool = n->next;
-      hv_free(n);
-    }
-  }
-}
-
 #if HV_APPLE
 #pragma mark - HvMessagePool
 #endif
 
 static hv_size_t mp_messagelistIndexForSize(hv_size_t byteSize) {
-  return (hv_size_t) hv_max_i((hv_min_max_log2((hv_uint32_t) byteSize) - 5), 0);
+  return (hv_size_t) hv_max_i((hv_min_max_log2((hv_uint32_t) byteSize) - MP_MIN_CHUNK_SIZE_LOG2), 0);
 }
 
 hv_size_t mp_init(HvMessagePool *mp, hv_size_t numKB) {
   mp->bufferSize = numKB * 1024;
-  mp->buffer = (char *) hv_malloc(mp->bufferSize);
+  mp->buffer = (char *) hv_arena_malloc(mp->bufferSize);
   hv_assert(mp->buffer != NULL);
   mp->bufferIndex = 0;
 
   // initialise all message lists
   for (int i = 0; i < MP_NUM_MESSAGE_LISTS; i++) {
     mp->lists[i].head = NULL;
-    mp->lists[i].pool = NULL;
   }
 
   return mp->bufferSize;
 }
 
 void mp_free(HvMessagePool *mp) {
-  hv_free(mp->buffer);
-  for (int i = 0; i < MP_NUM_MESSAGE_LISTS; i++) {
-    ml_free(&mp->lists[i]);
-  }
+  hv_arena_free(mp->buffer);
 }
 
 void mp_freeMessage(HvMessagePool *mp, HvMessage *m) {
   const hv_size_t b = msg_getSize(m); // the number of bytes that a message occupies in memory
   const hv_size_t i = mp_messagelistIndexForSize(b); // the HvMessagePoolList index in the pool
   HvMessagePoolList *ml = &mp->lists[i];
-  const hv_size_t chunkSize = 32 << i;
+  const hv_size_t chunkSize = ((hv_size_t) 1 << MP_MIN_CHUNK_SIZE_LOG2) << i;
   hv_memclear(m, chunkSize); // clear the chunk, just in case
   ml_push(ml, m);
 }
@@ -115,12 +85,12 @@ void mp_freeMessage(HvMessagePool *mp, HvMessage *m) {
 HvMessage *mp_addMessage(HvMessagePool *mp, const HvMessage *m) {
   const hv_size_t b = msg_getSize(m);
   // determine the message list index to allocate data from based on the msg size
-  // smallest chunk size is 32 bytes
+  // smallest chunk size is 16 bytes
   const hv_size_t i = mp_messagelistIndexForSize(b);
 
-  hv_assert(i < MP_NUM_MESSAGE_LISTS); // how many chunk sizes do we want to support? 32, 64, 128, 256 at the moment
+  hv_assert(i < MP_NUM_MESSAGE_LISTS); // how many chunk sizes do we want to support? 16, 32, 64, 128, 256 at the moment
   HvMessagePoolList *ml = &mp->lists[i];
-  const hv_size_t chunkSize = 32 << i;
+  const hv_size_t chunkSize = ((hv_size_t) 1 << MP_MIN_CHUNK_SIZE_LOG2) << i;
 
   if (ml_hasAvailable(ml)) {
     char *buf = ml_pop(ml);
@@ -19,7 +19,10 @@
 
 #include "HvUtils.h"
 
-#define MP_NUM_MESSAGE_LISTS 4
+#define MP_NUM_MESSAGE_LISTS 5
+
+// the smallest chunk is 16 bytes, which holds a message with one element
+#define MP_MIN_CHUNK_SIZE_LOG2 4
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,7 +30,6 @@ extern "C" {
 
 typedef struct HvMessagePoolList {
   struct MessageListNode *head; // list of currently available blocks
-  struct MessageListNode *pool; // list of currently used blocks
 } HvMessagePoolList;
 
 typedef struct HvMessagePool {
@@ -41,9 +43,9 @@ typedef struct HvMessagePool {
 /**
  * The HvMessagePool is a basic memory management system. It reserves a large block of memory at initialisation
  * and proceeds to divide this block into smaller chunks (usually 512 bytes) as they are needed. These chunks are
- * further divided into 32, 64, 128, or 256 sections. Each of these sections is managed by a HvMessagePoolList (MPL).
- * An MPL is a linked-list data structure which is initialised such that its own pool of listnodes is filled with nodes
- * that point at each subblock (e.g. each 32-byte block of a 512-block chunk).
+ * further divided into 16, 32, 64, 128, or 256 sections. Each of these sections is managed by a HvMessagePoolList (MPL).
+ * An MPL is a linked list of the free subblocks (e.g. each 16-byte block of a 512-block chunk), threaded through the
+ * subblocks themselves, so that adding and freeing messages never allocates.
  *
  * HvMessagePool is loosely inspired by TCMalloc. http://goog-perftools.sourceforge.net/doc/tcmalloc.html
  */
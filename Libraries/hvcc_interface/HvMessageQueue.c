@@ -15,13 +15,36 @@
  */
 
 #include "HvMessageQueue.h"
+#include "HvArena.h"
+
+// one node is reserved up front for every this many bytes of message pool
+#define MQ_POOL_BYTES_PER_NODE 64
+
+/**
+ * Adds numNodes empty nodes to the reserve pool, from the arena if one is given. Arena nodes are taken
+ * as one block and released with the arena, heap nodes are freed one by one.
+ */
+static void mq_reserveNodes(HvMessageQueue *q, HvArena *arena, hv_size_t numNodes) {
+  MessageNode *n = (arena != NULL) ? (MessageNode *) hArena_alloc(arena, numNodes * sizeof(MessageNode)) : NULL;
+  for (hv_size_t i = 0; i < numNodes; ++i) {
+    MessageNode *m = (n != NULL) ? (n + i) : (MessageNode *) hv_malloc(sizeof(MessageNode));
+    hv_assert(m != NULL);
+    m->heap = (n == NULL);
+    m->next = q->pool;
+    q->pool = m;
+  }
+}
 
 hv_size_t mq_initWithPoolSize(HvMessageQueue *q, hv_size_t poolSizeKB) {
   hv_assert(poolSizeKB > 0);
   q->head = NULL;
   q->tail = NULL;
   q->pool = NULL;
-  return mp_init(&q->mp, poolSizeKB);
+
+  // fill the reserve pool while constructing, so that scheduling rarely has to allocate
+  const hv_size_t numNodes = (poolSizeKB * 1024) / MQ_POOL_BYTES_PER_NODE;
+  mq_reserveNodes(q, hArena_getActive(), numNodes);
+  return mp_init(&q->mp, poolSizeKB) + numNodes * sizeof(MessageNode);
 }
 
 void mq_free(HvMessageQueue *q) {
@@ -29,23 +52,69 @@ void mq_free(HvMessageQueue *q) {
   while (q->pool != NULL) {
     MessageNode *n = q->pool;
     q->pool = q->pool->next;
-    hv_free(n);
+    if (n->heap) hv_free(n);
   }
   mp_free(&q->mp);
 }
 
 static MessageNode *mq_getOrCreateNodeFromPool(HvMessageQueue *q) {
   if (q->pool == NULL) {
-    // if necessary, create a new empty node
-    q->pool = (MessageNode *) hv_malloc(sizeof(MessageNode));
-    hv_assert(q->pool != NULL);
-    q->pool->next = NULL;
+    // if necessary, create a new empty node. This happens while processing, so the node comes from the
+    // heap rather than from a new chunk of the arena, which would have to be mapped and locked.
+    mq_reserveNodes(q, NULL, 1);
   }
   MessageNode *node = q->pool;
   q->pool = q->pool->next;
+  node->owner = NULL;
+  node->ownerPrev = NULL;
+  node->ownerNext = NULL;
   return node;
 }
 
+/** Frees the message of a node that is no longer in the queue, and returns the node to the pool. */
+static void mq_releaseNode(HvMessageQueue *q, MessageNode *n) {
+  mq_list_remove(n);
+  mp_freeMessage(&q->mp, n->m);
+  n->m = NULL;
+  n->let = 0;
+  n->sendMessage = NULL;
+  n->next = q->pool;
+  n->prev = NULL;
+  q->pool = n;
+}
+
+void mq_list_append(MessageNodeList *l, MessageNode *n) {
+  hv_assert(n->owner == NULL);
+  n->owner = l;
+  n->ownerPrev = l->tail;
+  n->ownerNext = NULL;
+  if (l->tail != NULL) l->tail->ownerNext = n;
+  else l->head = n;
+  l->tail = n;
+}
+
+void mq_list_remove(MessageNode *n) {
+  MessageNodeList *l = n->owner;
+  if (l == NULL) return;
+  if (n->ownerPrev != NULL) n->ownerPrev->ownerNext = n->ownerNext;
+  else l->head = n->ownerNext;
+  if (n->ownerNext != NULL) n->ownerNext->ownerPrev = n->ownerPrev;
+  else l->tail = n->ownerPrev;
+  n->owner = NULL;
+  n->ownerPrev = NULL;
+  n->ownerNext = NULL;
+}
+
+void mq_list_moveAll(MessageNodeList *to, MessageNodeList *from) {
+  if (from == to || mq_list_isEmpty(from)) return;
+  for (MessageNode *n = from->head; n != NULL; n = n->ownerNext) n->owner = to;
+  from->head->ownerPrev = to->tail;
+  if (to->tail != NULL) to->tail->ownerNext = from->head;
+  else to->head = from->head;
+  to->tail = from->tail;
+  mq_list_init(from);
+}
+
 int mq_size(HvMessageQueue *q) {
   int size = 0;
   MessageNode *n = q->head;
@@ -79,106 +148,86 @@ HvMessage *mq_addMessage(HvMessageQueue *q, const HvMessage *m, int let,
   return mq_node_getMessage(node);
 }
 
-HvMessage *mq_addMessageByTimestamp(HvMessageQueue *q, const HvMessage *m, int let,
-    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
-  if (mq_hasMessage(q)) {
-    MessageNode *n = mq_getOrCreateNodeFromPool(q);
-    n->m = mp_addMessage(&q->mp, m);
-    n->let = let;
-    n->sendMessage = sendMessage;
-
-    if (msg_getTimestamp(m) < msg_getTimestamp(q->head->m)) {
-      // the message occurs before the current head
-      n->next = q->head;
-      q->head->prev = n;
-      n->prev = NULL;
-      q->head = n;
-    } else if (msg_getTimestamp(m) >= msg_getTimestamp(q->tail->m)) {
-      // the message occurs after the current tail
-      n->next = NULL;
-      n->prev = q->tail;
-      q->tail->next = n;
-      q->tail = n;
-    } else {
-      // the message occurs somewhere between the head and tail
-      MessageNode *node = q->head;
-      while (node != NULL) {
-        if (msg_getTimestamp(m) < msg_getTimestamp(node->next->m)) {
-          MessageNode *r = node->next;
-          node->next = n;
-          n->next = r;
-          n->prev = node;
-          r->prev = n;
-          break;
-        }
-        node = node->next;
+MessageNode *mq_addOwnedMessageByTimestamp(HvMessageQueue *q, const HvMessage *m, int let,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *), MessageNodeList *owner) {
+  MessageNode *n = mq_getOrCreateNodeFromPool(q);
+  n->m = mp_addMessage(&q->mp, m);
+  n->let = let;
+  n->sendMessage = sendMessage;
+
+  if (!mq_hasMessage(q)) {
+    // the queue is empty
+    n->next = NULL;
+    n->prev = NULL;
+    q->head = n;
+    q->tail = n;
+  } else if (msg_isTimestampBefore(msg_getTimestamp(m), msg_getTimestamp(q->head->m))) {
+    // the message occurs before the current head
+    n->next = q->head;
+    q->head->prev = n;
+    n->prev = NULL;
+    q->head = n;
+  } else if (!msg_isTimestampBefore(msg_getTimestamp(m), msg_getTimestamp(q->tail->m))) {
+    // the message occurs after the current tail
+    n->next = NULL;
+    n->prev = q->tail;
+    q->tail->next = n;
+    q->tail = n;
+  } else {
+    // the message occurs somewhere between the head and tail
+    MessageNode *node = q->head;
+    while (node != NULL) {
+      if (msg_isTimestampBefore(msg_getTimestamp(m), msg_getTimestamp(node->next->m))) {
+        MessageNode *r = node->next;
+        node->next = n;
+        n->next = r;
+        n->prev = node;
+        r->prev = n;
+        break;
       }
+      node = node->next;
     }
-    return n->m;
-  } else {
-    // add a message to the head
-    return mq_addMessage(q, m, let, sendMessage);
   }
+
+  if (owner != NULL) mq_list_append(owner, n);
+  return n;
+}
+
+HvMessage *mq_addMessageByTimestamp(HvMessageQueue *q, const HvMessage *m, int let,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
+  return mq_node_getMessage(mq_addOwnedMessageByTimestamp(q, m, let, sendMessage, NULL));
 }
 
 void mq_pop(HvMessageQueue *q) {
   if (mq_hasMessage(q)) {
     MessageNode *n = q->head;
-
-    mp_freeMessage(&q->mp, n->m);
-    n->m = NULL;
-
-    n->let = 0;
-    n->sendMessage = NULL;
-
     q->head = n->next;
     if (q->head == NULL) {
       q->tail = NULL;
     } else {
       q->head->prev = NULL;
     }
-    n->next = q->pool;
-    n->prev = NULL;
-    q->pool = n;
+    mq_releaseNode(q, n);
   }
 }
 
+void mq_removeNode(HvMessageQueue *q, MessageNode *n) {
+  if (n->prev != NULL) n->prev->next = n->next;
+  else q->head = n->next;
+  if (n->next != NULL) n->next->prev = n->prev;
+  else q->tail = n->prev;
+  mq_releaseNode(q, n);
+}
+
 bool mq_removeMessage(HvMessageQueue *q, HvMessage *m, void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
-  if (mq_hasMessage(q)) {
-    if (mq_node_getMessage(q->head) == m) { // msg in head node
-      // only remove the message if sendMessage is the same as the stored one,
-      // if the sendMessage argument is NULL, it is not checked and will remove any matching message pointer
-      if (sendMessage == NULL || q->head->sendMessage == sendMessage) {
-        mq_pop(q);
-        return true;
-      }
-    } else {
-      MessageNode *prevNode = q->head;
-      MessageNode *currNode = q->head->next;
-      while ((currNode != NULL) && (currNode->m != m)) {
-        prevNode = currNode;
-        currNode = currNode->next;
-      }
-      if (currNode != NULL) {
-        if (sendMessage == NULL || currNode->sendMessage == sendMessage) {
-          mp_freeMessage(&q->mp, m);
-          currNode->m = NULL;
-          currNode->let = 0;
-          currNode->sendMessage = NULL;
-          if (currNode == q->tail) { // msg in tail node
-            prevNode->next = NULL;
-            q->tail = prevNode;
-          } else { // msg in middle node
-            prevNode->next = currNode->next;
-            currNode->next->prev = prevNode;
-          }
-          currNode->next = (q->pool == NULL) ? NULL : q->pool;
-          currNode->prev = NULL;
-          q->pool = currNode;
-          return true;
-        }
-      }
-    }
+  MessageNode *n = q->head;
+  while ((n != NULL) && (n->m != m)) n = n->next;
+
+  // only remove the message if sendMessage is the same as the stored one,
+  // if the sendMessage argument is NULL, it is not checked and will remove any matching message pointer
+  if ((n != NULL) && (sendMessage == NULL || n->sendMessage == sendMessage)) {
+    mq_removeNode(q, n);
+    return true;
   }
   return false;
 }
@@ -191,25 +240,15 @@ void mq_clear(HvMessageQueue *q) {
 
 void mq_clearAfter(HvMessageQueue *q, const hv_uint32_t timestamp) {
   MessageNode *n = q->tail;
-  while (n != NULL && timestamp <= msg_getTimestamp(n->m)) {
-    // free the node's message
-    mp_freeMessage(&q->mp, n->m);
-    n->m = NULL;
-    n->let = 0;
-    n->sendMessage = NULL;
-
+  while (n != NULL && !msg_isTimestampBefore(msg_getTimestamp(n->m), timestamp)) {
     // the tail points at the previous node
     q->tail = n->prev;
-
-    // put the node back in the pool
-    n->next = q->pool;
-    n->prev = NULL;
-    if (q->pool != NULL) q->pool->prev = n;
-    q->pool = n;
+    mq_releaseNode(q, n);
 
     // update the tail node
     n = q->tail;
   }
 
   if (q->tail == NULL) q->head = NULL;
+  else q->tail->next = NULL;
 }
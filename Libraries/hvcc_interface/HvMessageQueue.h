@@ -36,8 +36,21 @@ typedef struct MessageNode {
   HvMessage *m;
   void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *);
   int let;
+  bool heap; // taken from the heap because the reserve pool ran out, rather than from the arena
+  struct MessageNodeList *owner; // the list of the object that scheduled this message, or NULL
+  struct MessageNode *ownerPrev; // doubly linked list of the owner
+  struct MessageNode *ownerNext;
 } MessageNode;
 
+/**
+ * The pending messages of one object, linked through their queue nodes. Nodes are added and removed
+ * in constant time, and a node leaves its list by itself when the queue releases it.
+ */
+typedef struct MessageNodeList {
+  MessageNode *head;
+  MessageNode *tail;
+} MessageNodeList;
+
 /** A doubly linked list containing scheduled messages. */
 typedef struct HvMessageQueue {
   MessageNode *head; // the head of the queue
@@ -66,13 +79,31 @@ static inline bool mq_hasMessage(HvMessageQueue *q) {
 
 // true if there is a message and it occurs before (<) timestamp
 static inline bool mq_hasMessageBefore(HvMessageQueue *const q, const hv_uint32_t timestamp) {
-  return mq_hasMessage(q) && (msg_getTimestamp(mq_node_getMessage(q->head)) < timestamp);
+  return mq_hasMessage(q) && msg_isTimestampBefore(msg_getTimestamp(mq_node_getMessage(q->head)), timestamp);
 }
 
 static inline MessageNode *mq_peek(HvMessageQueue *q) {
   return q->head;
 }
 
+static inline void mq_list_init(MessageNodeList *l) {
+  l->head = NULL;
+  l->tail = NULL;
+}
+
+static inline bool mq_list_isEmpty(const MessageNodeList *l) {
+  return (l->head == NULL);
+}
+
+/** Appends the node to the list. The node must not be in any list. */
+void mq_list_append(MessageNodeList *l, MessageNode *n);
+
+/** Removes the node from its list, if it is in one. The node stays in the queue. */
+void mq_list_remove(MessageNode *n);
+
+/** Moves all nodes from one list to the end of another. */
+void mq_list_moveAll(MessageNodeList *to, MessageNodeList *from);
+
 /** Appends the message to the end of the queue. */
 HvMessage *mq_addMessage(HvMessageQueue *q, const HvMessage *m, int let,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *));
@@ -81,6 +112,10 @@ HvMessage *mq_addMessage(HvMessageQueue *q, const HvMessage *m, int let,
 HvMessage *mq_addMessageByTimestamp(HvMessageQueue *q, const HvMessage *m, int let,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *));
 
+/** Like mq_addMessageByTimestamp(), but also appends the new node to the owner's list. */
+MessageNode *mq_addOwnedMessageByTimestamp(HvMessageQueue *q, const HvMessage *m, int let,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *), MessageNodeList *owner);
+
 /** Pop the message at the head of the queue (and free its memory). */
 void mq_pop(HvMessageQueue *q);
 
@@ -88,6 +123,9 @@ void mq_pop(HvMessageQueue *q);
 bool mq_removeMessage(HvMessageQueue *q, HvMessage *m,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *));
 
+/** Remove a node from the queue (and free its message) in constant time. */
+void mq_removeNode(HvMessageQueue *q, MessageNode *n);
+
 /** Clears (and frees) all messages in the queue. */
 void mq_clear(HvMessageQueue *q);
 
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "HvPerfectHash.h"
+
+// the number of displacements that are tried for a bucket before the table is made larger
+#define HV_PERFECT_HASH_MAX_ATTEMPTS 4096
+
+static void hPh_clearSlot(HvPerfectHashSlot *s) {
+  s->key = 0;
+  s->index = -1;
+}
+
+// places all keys of one bucket into free slots, or none of them
+static bool hPh_placeBucket(HvPerfectHash *o, const hv_uint32_t *keys, int numKeys, hv_uint32_t b, hv_uint32_t *placed) {
+  for (hv_uint32_t d = 0; d < HV_PERFECT_HASH_MAX_ATTEMPTS; ++d) {
+    int numPlaced = 0;
+    bool ok = true;
+    for (int i = 0; (i < numKeys) && ok; ++i) {
+      if (hPh_getBucket(o, keys[i]) != b) continue;
+      HvPerfectHashSlot *s = o->slots + hPh_getSlot(o, keys[i], d);
+      if (s->index == -1) {
+        s->key = keys[i];
+        s->index = i;
+        placed[numPlaced++] = (hv_uint32_t) (s - o->slots);
+      } else if (s->key != keys[i]) {
+        ok = false; // equal keys are always in the same bucket, so anything else is a collision
+      }
+    }
+    if (ok) {
+      o->displacements[b] = d;
+      return true;
+    }
+    for (int i = 0; i < numPlaced; ++i) hPh_clearSlot(o->slots + placed[i]);
+  }
+  return false;
+}
+
+static bool hPh_build(HvPerfectHash *o, const hv_uint32_t *keys, int numKeys, hv_uint32_t *bucketSizes, hv_uint32_t *placed) {
+  const hv_uint32_t numSlots = 1U << (32 - o->slotShift);
+  const hv_uint32_t numBuckets = 1U << (32 - o->bucketShift);
+  for (hv_uint32_t i = 0; i < numSlots; ++i) hPh_clearSlot(o->slots + i);
+  for (hv_uint32_t i = 0; i < numBuckets; ++i) {
+    o->displacements[i] = 0;
+    bucketSizes[i] = 0;
+  }
+
+  hv_uint32_t maxBucketSize = 0;
+  for (int i = 0; i < numKeys; ++i) {
+    const hv_uint32_t b = hPh_getBucket(o, keys[i]);
+    maxBucketSize = hv_max_ui(maxBucketSize, ++bucketSizes[b]);
+  }
+
+  // the largest buckets are the hardest to place, so they go first
+  for (hv_uint32_t size = maxBucketSize; size > 0; --size) {
+    for (hv_uint32_t b = 0; b < numBuckets; ++b) {
+      if ((bucketSizes[b] == size) && !hPh_placeBucket(o, keys, numKeys, b, placed)) return false;
+    }
+  }
+  return true;
+}
+
+hv_size_t hPh_init(HvPerfectHash *o, const hv_uint32_t *keys, int numKeys) {
+  // at least twice as many slots as keys, and one bucket per key. Two buckets keep the shifts below 32
+  hv_uint32_t bits = 2;
+  while ((1U << bits) < 2 * (hv_uint32_t) numKeys) ++bits;
+
+  while (true) {
+    const hv_size_t numSlots = ((hv_size_t) 1) << bits;
+    const hv_size_t numBuckets = numSlots / 2;
+    o->slotShift = 32 - bits;
+    o->bucketShift = 32 - (bits - 1);
+
+    // hv_malloc may require sizes to be a multiple of its alignment
+    const hv_size_t slotBytes = numSlots * sizeof(HvPerfectHashSlot);
+    const hv_size_t bucketBytes = ((numBuckets * sizeof(hv_uint32_t)) + 31) & ~((hv_size_t) 31);
+    o->slots = (HvPerfectHashSlot *) hv_malloc(slotBytes);
+    o->displacements = (hv_uint32_t *) hv_malloc(bucketBytes);
+    hv_assert((o->slots != NULL) && (o->displacements != NULL));
+
+    hv_uint32_t *bucketSizes = (hv_uint32_t *) hv_malloc(bucketBytes);
+    hv_uint32_t *placed = (hv_uint32_t *) hv_malloc(slotBytes);
+    const bool built = hPh_build(o, keys, numKeys, bucketSizes, placed);
+    hv_free(bucketSizes);
+    hv_free(placed);
+    if (built) return slotBytes + bucketBytes;
+
+    // a sparser table makes collisions less likely
+    hPh_free(o);
+    ++bits;
+  }
+}
+
+void hPh_free(HvPerfectHash *o) {
+  hv_free(o->slots);
+  hv_free(o->displacements);
+  o->slots = NULL;
+  o->displacements = NULL;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef _HEAVY_PERFECT_HASH_H_
+#define _HEAVY_PERFECT_HASH_H_
+
+#include "HvUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maps a fixed set of receiver, send or table hashes to their index in the set, without collisions.
+ * The set is known once a patch is loaded, so the table is built with hash and displace: every hash
+ * first picks a bucket, and each bucket has a displacement that was searched for such that all of its
+ * hashes land in their own slot. A lookup is then two multiplications and one comparison, instead of
+ * a chain of comparisons.
+ */
+typedef struct HvPerfectHashSlot {
+  hv_uint32_t key;
+  hv_int32_t index; // -1 if the slot is empty
+} HvPerfectHashSlot;
+
+typedef struct HvPerfectHash {
+  HvPerfectHashSlot *slots;
+  hv_uint32_t *displacements; // one per bucket
+  hv_uint32_t slotShift; // 32 - log2(number of slots)
+  hv_uint32_t bucketShift; // 32 - log2(number of buckets)
+} HvPerfectHash;
+
+#define HV_PERFECT_HASH_BUCKET_MULTIPLIER 0x9E3779B1U
+#define HV_PERFECT_HASH_SLOT_MULTIPLIER 0x85EBCA77U
+
+/**
+ * Builds the table for the given hashes. Duplicate hashes map to their first index.
+ * @return  The number of bytes allocated.
+ */
+hv_size_t hPh_init(HvPerfectHash *o, const hv_uint32_t *keys, int numKeys);
+
+void hPh_free(HvPerfectHash *o);
+
+static inline hv_uint32_t hPh_getBucket(const HvPerfectHash *o, hv_uint32_t key) {
+  return (key * HV_PERFECT_HASH_BUCKET_MULTIPLIER) >> o->bucketShift;
+}
+
+static inline hv_uint32_t hPh_getSlot(const HvPerfectHash *o, hv_uint32_t key, hv_uint32_t displacement) {
+  return ((key ^ displacement) * HV_PERFECT_HASH_SLOT_MULTIPLIER) >> o->slotShift;
+}
+
+/** Returns the index of the hash in the set given to hPh_init(), or -1 if it is not in the set. */
+static inline int hPh_find(const HvPerfectHash *o, hv_uint32_t key) {
+  const HvPerfectHashSlot *s = o->slots + hPh_getSlot(o, key, o->displacements[hPh_getBucket(o, key)]);
+  return (s->key == key) ? s->index : -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HEAVY_PERFECT_HASH_H_
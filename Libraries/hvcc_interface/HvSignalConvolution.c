@@ -54,10 +54,45 @@ void sConv_onMessage(HeavyContextInterface *_c, SignalConvolution *o, int letInd
   }
 }
 
-static hv_bInf_t sConv_kernel(hv_bInf_t bIn, hv_bInf_t bInPrev, hv_bInf_t bInCoeff) {
+// adds the products of the inputs and coefficients to the accumulated output
+static hv_bInf_t sConv_kernel(hv_bInf_t bIn, hv_bInf_t bInPrev, hv_bInf_t bInCoeff, hv_bInf_t bInAcc) {
 #if HV_SIMD_AVX
-  hv_assert(false & "There is no AVX implementation of __hv_conv_f");
-  hv_bufferf_t d = _mm256_setzero_ps();
+  // broadcast each coefficient. AVX only permutes within 128-bit lanes, so first copy each half
+  // of the coefficients to both lanes.
+  __m256 cl = _mm256_permute2f128_ps(bInCoeff, bInCoeff, 0x00);
+  __m256 ch = _mm256_permute2f128_ps(bInCoeff, bInCoeff, 0x11);
+  __m256 c0 = _mm256_permute_ps(cl, _MM_SHUFFLE(0,0,0,0));
+  __m256 c1 = _mm256_permute_ps(cl, _MM_SHUFFLE(1,1,1,1));
+  __m256 c2 = _mm256_permute_ps(cl, _MM_SHUFFLE(2,2,2,2));
+  __m256 c3 = _mm256_permute_ps(cl, _MM_SHUFFLE(3,3,3,3));
+  __m256 c4 = _mm256_permute_ps(ch, _MM_SHUFFLE(0,0,0,0));
+  __m256 c5 = _mm256_permute_ps(ch, _MM_SHUFFLE(1,1,1,1));
+  __m256 c6 = _mm256_permute_ps(ch, _MM_SHUFFLE(2,2,2,2));
+  __m256 c7 = _mm256_permute_ps(ch, _MM_SHUFFLE(3,3,3,3));
+
+  // mk is the input delayed by k samples, built in the same way as for SSE within each lane
+  __m256 m0 = bIn;
+  __m256 m4 = _mm256_permute2f128_ps(bInPrev, bIn, 0x21);
+  __m256 m2 = _mm256_shuffle_ps(m4, bIn, _MM_SHUFFLE(1,0,3,2));
+  __m256 m1 = _mm256_shuffle_ps(m2, bIn, _MM_SHUFFLE(2,1,2,1));
+  __m256 m3 = _mm256_shuffle_ps(m4, m2, _MM_SHUFFLE(2,1,2,1));
+  __m256 m6 = _mm256_shuffle_ps(bInPrev, m4, _MM_SHUFFLE(1,0,3,2));
+  __m256 m5 = _mm256_shuffle_ps(m6, m4, _MM_SHUFFLE(2,1,2,1));
+  __m256 m7 = _mm256_shuffle_ps(bInPrev, m6, _MM_SHUFFLE(2,1,2,1));
+
+  // each group of four taps is summed and accumulated separately, in the same order as the SSE
+  // kernel, so that both give bit-identical results
+  hv_bufferf_t a, b, c, d;
+  __hv_mul_f(c0, m0, &a);
+  __hv_fma_f(c1, m1, a, &b);
+  __hv_fma_f(c2, m2, b, &c);
+  __hv_fma_f(c3, m3, c, &d);
+  __hv_add_f(d, bInAcc, &d);
+  __hv_mul_f(c4, m4, &a);
+  __hv_fma_f(c5, m5, a, &b);
+  __hv_fma_f(c6, m6, b, &c);
+  __hv_fma_f(c7, m7, c, &a);
+  __hv_add_f(a, d, &d);
 #elif HV_SIMD_SSE
   __m128 c0 = _mm_shuffle_ps(bInCoeff, bInCoeff, _MM_SHUFFLE(0,0,0,0));
   __m128 c1 = _mm_shuffle_ps(bInCoeff, bInCoeff, _MM_SHUFFLE(1,1,1,1));
@@ -74,6 +109,7 @@ static hv_bInf_t sConv_kernel(hv_bInf_t bIn, hv_bInf_t bInPrev, hv_bInf_t bInCoe
   __hv_fma_f(c1, m1, a, &b);
   __hv_fma_f(c2, m2, b, &c);
   __hv_fma_f(c3, m3, c, &d);
+  __hv_add_f(d, bInAcc, &d);
 #elif HV_SIMD_NEON
   float32x4_t c0 = vdupq_lane_f32(vget_low_f32(bInCoeff), 0);
   float32x4_t c1 = vdupq_lane_f32(vget_low_f32(bInCoeff), 1);
@@ -90,8 +126,9 @@ static hv_bInf_t sConv_kernel(hv_bInf_t bIn, hv_bInf_t bInPrev, hv_bInf_t bInCoe
   __hv_fma_f(c1, m1, a, &b);
   __hv_fma_f(c2, m2, b, &c);
   __hv_fma_f(c3, m3, c, &d);
+  __hv_add_f(d, bInAcc, &d);
 #else // HV_SIMD_NONE
-  hv_bufferf_t d = bIn * bInCoeff;
+  hv_bufferf_t d = bIn * bInCoeff + bInAcc;
 #endif
 
   return d;
@@ -122,21 +159,19 @@ void __hv_conv_f(SignalConvolution *o, hv_bInf_t bIn, hv_bOutf_t bOut) {
 
   int i = 0;
   int h = wrap(h_orig-HV_N_SIMD, m);
-  for (; h >= 0; i+=HV_N_SIMD, h-=HV_N_SIMD) {
-    hv_bufferf_t x1, c, o;
+  for (; i < n && h >= 0; i+=HV_N_SIMD, h-=HV_N_SIMD) {
+    hv_bufferf_t x1, c;
     __hv_load_f(inputs+h, &x1);
     __hv_load_f(coeffs+i, &c);
-    o = sConv_kernel(x0, x1, c);
-    __hv_add_f(o, out, &out);
+    out = sConv_kernel(x0, x1, c, out);
     x0 = x1;
   }
   h += m; // h = m-HV_N_SIMD;
   for (; i < n; i+=HV_N_SIMD, h-=HV_N_SIMD) {
-    hv_bufferf_t x1, c, o;
+    hv_bufferf_t x1, c;
     __hv_load_f(inputs+h, &x1);
     __hv_load_f(coeffs+i, &c);
-    o = sConv_kernel(x0, x1, c);
-    __hv_add_f(o, out, &out);
+    out = sConv_kernel(x0, x1, c, out);
     x0 = x1;
   }
 
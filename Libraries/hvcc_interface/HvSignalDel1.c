@@ -31,7 +31,7 @@ hv_size_t sDel1_init(SignalDel1 *o) {
 
 void sDel1_onMessage(HeavyContextInterface *_c, SignalDel1 *o, int letIn, const HvMessage *m) {
   if (letIn == 2) {
-    if (msg_compareSymbol(m, 0, "clear")) {
+    if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_clear)) {
 #if HV_SIMD_AVX
       o->x = _mm256_setzero_ps();
 #elif HV_SIMD_SSE
@@ -30,17 +30,23 @@ hv_size_t sEnv_init(SignalEnvelope *o, int windowSize, int period) {
   o->windowSize = (windowSize <= HV_N_SIMD) ? HV_N_SIMD : ceilToNearestBlock(windowSize, HV_N_SIMD);
   o->period = (period <= HV_N_SIMD) ? HV_N_SIMD : (period > o->windowSize) ? o->windowSize : ceilToNearestBlock(period, HV_N_SIMD);
   o->numSamplesInBuffer = 0;
+  o->head = 0;
+  o->recursive = HV_ENVELOPE_RECURSIVE;
+  o->sum = 0.0;
   hv_size_t numBytes = 0;
 
   // allocate the signal buffer
-  // the buffer is overdimensioned in this way (up to double), but not by much and so what
+  // every sample is written twice, at head and at head+windowSize, such that the window always
+  // starts at buffer+head and can be read without wrapping. The running sum only uses the first
+  // half, which holds the same ring in both modes, so that the mode can change at any time.
   const int bufferLength = 2 * o->windowSize;
-  o->buffer = (float *) hv_malloc(bufferLength*sizeof(float));
+  o->buffer = (float *) hv_arena_malloc(bufferLength*sizeof(float));
   hv_assert(o->buffer != NULL);
+  hv_memclear(o->buffer, bufferLength*sizeof(float));
   numBytes += bufferLength*sizeof(float);
 
   // allocate and calculate the hanning weights
-  o->hanningWeights = (float *) hv_malloc(o->windowSize*sizeof(float));
+  o->hanningWeights = (float *) hv_arena_malloc(o->windowSize*sizeof(float));
   hv_assert(o->hanningWeights != NULL);
   numBytes += o->windowSize*sizeof(float);
   float hanningSum = 0.0f;
@@ -58,8 +64,39 @@ hv_size_t sEnv_init(SignalEnvelope *o, int windowSize, int period) {
 }
 
 void sEnv_free(SignalEnvelope *o) {
-  hv_free(o->hanningWeights);
-  hv_free(o->buffer);
+  hv_arena_free(o->hanningWeights);
+  hv_arena_free(o->buffer);
+}
+
+void sEnv_setRecursive(SignalEnvelope *o, bool recursive) {
+  if (recursive == o->recursive) return;
+  o->recursive = recursive;
+  if (recursive) {
+    double sum = 0.0;
+    for (int i = 0; i < o->windowSize; ++i) sum += o->buffer[i];
+    o->sum = sum;
+  } else {
+    // restore the mirror, which the running sum does not keep
+    hv_memcpy(o->buffer + o->windowSize, o->buffer, o->windowSize*sizeof(float));
+  }
+}
+
+// returns the sum of all elements of the vector
+static inline float sEnv_horizontalSum(hv_bInf_t bIn) {
+#if HV_SIMD_AVX
+  __m128 x = _mm_add_ps(_mm256_castps256_ps128(bIn), _mm256_extractf128_ps(bIn, 1));
+  x = _mm_hadd_ps(x, x);
+  x = _mm_hadd_ps(x, x);
+  return _mm_cvtss_f32(x);
+#elif HV_SIMD_SSE
+  __m128 x = _mm_hadd_ps(bIn, bIn);
+  x = _mm_hadd_ps(x, x);
+  return _mm_cvtss_f32(x);
+#elif HV_SIMD_NEON
+  return bIn[0]+bIn[1]+bIn[2]+bIn[3];
+#else // HV_SIMD_NONE
+  return bIn;
+#endif
 }
 
 static void sEnv_sendMessage(HeavyContextInterface *_c, SignalEnvelope *o, float rms,
@@ -74,76 +111,76 @@ static void sEnv_sendMessage(HeavyContextInterface *_c, SignalEnvelope *o, float
   msg_initWithFloat(m, hv_getCurrentSample(_c) + HV_N_SIMD, (rms < 0.0f) ? 0.0f : rms);
   hv_scheduleMessageForObject(_c, m, sendMessage, 0);
 
-  hv_memcpy(o->buffer, o->buffer+o->period, sizeof(float)*(o->numSamplesInBuffer - o->period));
+  // the ring buffer keeps the whole window, only wait for the next period
   o->numSamplesInBuffer -= o->period;
 }
 
-void sEnv_process(HeavyContextInterface *_c, SignalEnvelope *o, hv_bInf_t bIn,
+// replaces the oldest block of the window with the new one and updates the running sum
+static inline void sEnv_processRecursive(HeavyContextInterface *_c, SignalEnvelope *o, hv_bInf_t x,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
-#if HV_SIMD_AVX
-  _mm256_stream_ps(o->buffer+o->numSamplesInBuffer, _mm256_mul_ps(bIn,bIn)); // store bIn^2, no need to cache block
-  o->numSamplesInBuffer += HV_N_SIMD;
-
-  if (o->numSamplesInBuffer >= o->windowSize) {
-    int n4 = o->windowSize & ~HV_N_SIMD_MASK;
-    __m256 sum = _mm256_setzero_ps();
-    while (n4) {
-      __m256 x = _mm256_load_ps(o->buffer + n4 - HV_N_SIMD);
-      __m256 h = _mm256_load_ps(o->hanningWeights + n4 - HV_N_SIMD);
-      x = _mm256_mul_ps(x, h);
-      sum = _mm256_add_ps(sum, x);
-      n4 -= HV_N_SIMD;
-    }
-    sum = _mm256_hadd_ps(sum,sum); // horizontal sum
-    sum = _mm256_hadd_ps(sum,sum);
-    sEnv_sendMessage(_c, o, sum[0]+sum[4], sendMessage); // updates numSamplesInBuffer
+  hv_bufferf_t y, d;
+  __hv_load_f(o->buffer + o->head, &y);
+  __hv_store_f(o->buffer + o->head, x);
+  __hv_sub_f(x, y, &d);
+  o->sum += (double) sEnv_horizontalSum(d);
+
+  o->head += HV_N_SIMD;
+  if (o->head == o->windowSize) {
+    // recompute the sum once per window such that rounding errors cannot accumulate
+    o->head = 0;
+    double sum = 0.0;
+    for (int i = 0; i < o->windowSize; ++i) sum += o->buffer[i];
+    o->sum = sum;
   }
-#elif HV_SIMD_SSE
-  _mm_stream_ps(o->buffer+o->numSamplesInBuffer, _mm_mul_ps(bIn,bIn)); // store bIn^2, no need to cache block
-  o->numSamplesInBuffer += HV_N_SIMD;
 
   if (o->numSamplesInBuffer >= o->windowSize) {
-    int n4 = o->windowSize & ~HV_N_SIMD_MASK;
-    __m128 sum = _mm_setzero_ps();
-    while (n4) {
-      __m128 x = _mm_load_ps(o->buffer + n4 - HV_N_SIMD);
-      __m128 h = _mm_load_ps(o->hanningWeights + n4 - HV_N_SIMD);
-      x = _mm_mul_ps(x, h);
-      sum = _mm_add_ps(sum, x);
-      n4 -= HV_N_SIMD;
-    }
-    sum = _mm_hadd_ps(sum,sum); // horizontal sum
-    sum = _mm_hadd_ps(sum,sum);
-    float f;
-    _mm_store_ss(&f, sum);
-    sEnv_sendMessage(_c, o, f, sendMessage);
+    const double ms = o->sum / o->windowSize;
+    sEnv_sendMessage(_c, o, (ms > 0.0) ? (float) ms : 0.0f, sendMessage);
   }
-#elif HV_SIMD_NEON
-  vst1q_f32(o->buffer+o->numSamplesInBuffer, vmulq_f32(bIn,bIn)); // store bIn^2, no need to cache block
-  o->numSamplesInBuffer += HV_N_SIMD;
+}
+
+// adds the new block to the ring and applies the Hann window to the whole window every period
+static inline void sEnv_processHann(HeavyContextInterface *_c, SignalEnvelope *o, hv_bInf_t x,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
+  __hv_store_f(o->buffer + o->head, x);
+  __hv_store_f(o->buffer + o->head + o->windowSize, x);
+  o->head += HV_N_SIMD;
+  if (o->head == o->windowSize) o->head = 0;
 
   if (o->numSamplesInBuffer >= o->windowSize) {
-    int n4 = o->windowSize & ~HV_N_SIMD_MASK;
-    float32x4_t sum = vdupq_n_f32(0.0f);
-    while (n4) {
-      float32x4_t x = vld1q_f32(o->buffer + n4 - HV_N_SIMD);
-      float32x4_t h = vld1q_f32(o->hanningWeights + n4 - HV_N_SIMD);
-      x = vmulq_f32(x, h);
-      sum = vaddq_f32(sum, x);
-      n4 -= HV_N_SIMD;
+    // the window starts at the oldest sample
+    float *const b = o->buffer + o->head;
+    float *const w = o->hanningWeights;
+    hv_bufferf_t sum0, sum1, y, h;
+    __hv_zero_f(&sum0);
+    __hv_zero_f(&sum1);
+
+    // two accumulators hide the latency of the multiply-add
+    int i = 0;
+    for (; i + 2*HV_N_SIMD <= o->windowSize; i += 2*HV_N_SIMD) {
+      __hv_load_f(b+i, &y);
+      __hv_load_f(w+i, &h);
+      __hv_fma_f(y, h, sum0, &sum0);
+      __hv_load_f(b+i+HV_N_SIMD, &y);
+      __hv_load_f(w+i+HV_N_SIMD, &h);
+      __hv_fma_f(y, h, sum1, &sum1);
     }
-    sEnv_sendMessage(_c, o, sum[0]+sum[1]+sum[2]+sum[3], sendMessage);
+    if (i < o->windowSize) {
+      __hv_load_f(b+i, &y);
+      __hv_load_f(w+i, &h);
+      __hv_fma_f(y, h, sum0, &sum0);
+    }
+    __hv_add_f(sum0, sum1, &sum0);
+    sEnv_sendMessage(_c, o, sEnv_horizontalSum(sum0), sendMessage);
   }
-#else // HV_SIMD_NONE
-  o->buffer[o->numSamplesInBuffer] = (bIn*bIn);
+}
+
+void sEnv_process(HeavyContextInterface *_c, SignalEnvelope *o, hv_bInf_t bIn,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
+  hv_bufferf_t x;
+  __hv_mul_f(bIn, bIn, &x);
   o->numSamplesInBuffer += HV_N_SIMD;
 
-  if (o->numSamplesInBuffer >= o->windowSize) {
-    float sum = 0.0f;
-    for (int i = 0; i < o->windowSize; ++i) {
-      sum += (o->hanningWeights[i] * o->buffer[i]);
-    }
-    sEnv_sendMessage(_c, o, sum, sendMessage);
-  }
-#endif
+  if (o->recursive) sEnv_processRecursive(_c, o, x, sendMessage);
+  else sEnv_processHann(_c, o, x, sendMessage);
 }
@@ -23,18 +23,35 @@
 extern "C" {
 #endif
 
+/**
+ * By default env~ computes the exact Hann-weighted mean square of the last windowSize samples
+ * every period. In recursive mode it instead keeps a running (rectangular) mean square, which
+ * costs O(1) per sample regardless of the window size but no longer applies the Hann window.
+ * The mode is chosen at compile time with HV_ENVELOPE_RECURSIVE, since env~ has no inlet that the
+ * generated code could send messages to. Hosts that call the runtime directly can still switch an
+ * object with sEnv_setRecursive().
+ */
+#ifndef HV_ENVELOPE_RECURSIVE
+#define HV_ENVELOPE_RECURSIVE 0
+#endif
+
 typedef struct SignalEnvelope {
 	int windowSize;
 	int period;
-	int numSamplesInBuffer;
+	int numSamplesInBuffer; // the number of samples received since the last output, up to windowSize
+	int head; // the index of the oldest sample in the ring buffer
+	bool recursive; // whether the mean square is a running sum rather than Hann-weighted
+	double sum; // the running sum of squares of the window (recursive mode only)
 	float *hanningWeights;
-	float *buffer;
+	float *buffer; // a ring of windowSize squared samples, mirrored so that the window is contiguous
 } SignalEnvelope;
 
 hv_size_t sEnv_init(SignalEnvelope *o, int windowSize, int period);
 
 void sEnv_free(SignalEnvelope *o);
 
+void sEnv_setRecursive(SignalEnvelope *o, bool recursive);
+
 void sEnv_process(HeavyContextInterface *_c, SignalEnvelope *o, hv_bInf_t bIn,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *));
 
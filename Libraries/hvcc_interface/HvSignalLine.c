@@ -103,7 +103,7 @@ void sLine_onMessage(HeavyContextInterface *_c, SignalLine *o, int letIn,
       o->t = msg_getFloat(m,0);
 #endif
     }
-  } else if (msg_compareSymbol(m,0,"stop")) {
+  } else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_stop)) {
     // Stop line at current position
 #if HV_SIMD_AVX
     // note o->n[1] is a 64-bit integer; two packed 32-bit ints. We only want to know if the high int is positive,
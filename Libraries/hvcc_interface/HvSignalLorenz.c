@@ -31,3 +31,46 @@ void sLorenz_onMessage(HeavyContextInterface *_c, SignalLorenz *o, int letIndex,
     o->zm1 = msg_getFloat(m,2);
   }
 }
+
+
+
+#if HV_APPLE
+#pragma mark - Lorenz Lanes
+#endif
+
+static void sLorenzLanes_setLane(SignalLorenzLanes *o, int lane, float x, float y, float z) {
+  ((float *) &o->x)[lane] = x;
+  ((float *) &o->y)[lane] = y;
+  ((float *) &o->z)[lane] = z;
+}
+
+static void sLorenzLanes_setAllLanes(SignalLorenzLanes *o, float x, float y, float z) {
+  for (int i = 0; i < HV_N_SIMD; ++i) {
+    sLorenzLanes_setLane(o, i, x + 0.01f*i, y, z);
+  }
+}
+
+static void sLorenzLanes_setNumSubsteps(SignalLorenzLanes *o, int numSubsteps) {
+  o->numSubsteps = (numSubsteps > 1) ? numSubsteps : 1;
+  o->invNumSubsteps = 1.0f / o->numSubsteps;
+}
+
+hv_size_t sLorenzLanes_init(SignalLorenzLanes *o, float x, float y, float z, int numSubsteps) {
+  sLorenzLanes_setAllLanes(o, x, y, z);
+  sLorenzLanes_setNumSubsteps(o, numSubsteps);
+  return 0;
+}
+
+void sLorenzLanes_onMessage(HeavyContextInterface *_c, SignalLorenzLanes *o, int letIndex,
+    const HvMessage *const m) {
+  if (msg_hasFormat(m, "fff")) {
+    sLorenzLanes_setAllLanes(o, msg_getFloat(m,0), msg_getFloat(m,1), msg_getFloat(m,2));
+  } else if (msg_hasFormat(m, "sffff") && msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_lane)) {
+    const int lane = (int) msg_getFloat(m,1);
+    if (lane >= 0 && lane < HV_N_SIMD) {
+      sLorenzLanes_setLane(o, lane, msg_getFloat(m,2), msg_getFloat(m,3), msg_getFloat(m,4));
+    }
+  } else if (msg_hasFormat(m, "sf") && msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_substeps)) {
+    sLorenzLanes_setNumSubsteps(o, (int) msg_getFloat(m,1));
+  }
+}
@@ -29,6 +29,15 @@ typedef struct SignalLorenz {
   float zm1;
 } SignalLorenz;
 
+// HV_N_SIMD independent Lorenz systems, one per lane of a vector
+typedef struct SignalLorenzLanes {
+  hv_bufferf_t x;
+  hv_bufferf_t y;
+  hv_bufferf_t z;
+  int numSubsteps; // the number of integration steps per call
+  float invNumSubsteps;
+} SignalLorenzLanes;
+
 hv_size_t sLorenz_init(SignalLorenz *o, float x, float y, float z);
 
 // https://en.wikipedia.org/wiki/Lorenz_system#Overview
@@ -127,6 +136,73 @@ static inline void __hv_lorenz_f(SignalLorenz *o,
 void sLorenz_onMessage(HeavyContextInterface *_c, SignalLorenz *o, int letIndex,
     const HvMessage *m);
 
+
+
+#if HV_APPLE
+#pragma mark - Lorenz Lanes
+#endif
+
+/**
+ * Lane i starts at (x + i*0.01, y, z), such that lanes with the same parameters still diverge.
+ * Each call advances every system by one step of bInStep, split into numSubsteps smaller steps.
+ */
+hv_size_t sLorenzLanes_init(SignalLorenzLanes *o, float x, float y, float z, int numSubsteps);
+
+/**
+ * Accepts "x y z" to restart all lanes as in sLorenzLanes_init(), "lane i x y z" to restart one
+ * lane, and "substeps n".
+ */
+void sLorenzLanes_onMessage(HeavyContextInterface *_c, SignalLorenzLanes *o, int letIndex,
+    const HvMessage *m);
+
+// Advances every lane with its own parameters from the lanes of bInStep, bInS, bInR and bInB.
+// The outputs hold the new state of each system, not consecutive samples of one system.
+static inline void __hv_lorenz_lanes_f(SignalLorenzLanes *o,
+    hv_bInf_t bInStep, hv_bInf_t bInS, hv_bInf_t bInR, hv_bInf_t bInB,
+    hv_bOutf_t bOutX, hv_bOutf_t bOutY, hv_bOutf_t bOutZ) {
+  hv_bufferf_t h, lo, hi, dx, dy, dz, t;
+#if HV_SIMD_AVX
+  h = _mm256_mul_ps(bInStep, _mm256_set1_ps(o->invNumSubsteps));
+  lo = _mm256_set1_ps(-100.0f);
+  hi = _mm256_set1_ps(100.0f);
+#elif HV_SIMD_SSE
+  h = _mm_mul_ps(bInStep, _mm_set1_ps(o->invNumSubsteps));
+  lo = _mm_set1_ps(-100.0f);
+  hi = _mm_set1_ps(100.0f);
+#elif HV_SIMD_NEON
+  h = vmulq_n_f32(bInStep, o->invNumSubsteps);
+  lo = vdupq_n_f32(-100.0f);
+  hi = vdupq_n_f32(100.0f);
+#else // HV_SIMD_NONE
+  h = bInStep * o->invNumSubsteps;
+  lo = -100.0f;
+  hi = 100.0f;
+#endif
+
+  for (int i = 0; i < o->numSubsteps; ++i) {
+    __hv_sub_f(o->y, o->x, &dx);
+    __hv_mul_f(bInS, dx, &dx); // s*(y-x)
+    __hv_sub_f(bInR, o->z, &t);
+    __hv_fms_f(o->x, t, o->y, &dy); // x*(r-z) - y
+    __hv_mul_f(bInB, o->z, &t);
+    __hv_fms_f(o->x, o->y, t, &dz); // x*y - b*z
+
+    __hv_fma_f(h, dx, o->x, &t);
+    __hv_min_f(t, hi, &t);
+    __hv_max_f(t, lo, &o->x);
+    __hv_fma_f(h, dy, o->y, &t);
+    __hv_min_f(t, hi, &t);
+    __hv_max_f(t, lo, &o->y);
+    __hv_fma_f(h, dz, o->z, &t);
+    __hv_min_f(t, hi, &t);
+    __hv_max_f(t, lo, &o->z);
+  }
+
+  *bOutX = o->x;
+  *bOutY = o->y;
+  *bOutZ = o->z;
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
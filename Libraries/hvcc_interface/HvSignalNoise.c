@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "HvSignalNoise.h"
+
+static void sNoise_seed(SignalNoise *o, hv_uint32_t seed) {
+  hv_uint32_t s[4];
+  hv_random_seed(s, seed);
+#if HV_SIMD_NONE
+  hv_memcpy(o->s, s, sizeof(s));
+#else
+  // lane i of word k is at index 4*(4*(i/4) + k) + (i%4)
+  hv_uint32_t *const w = (hv_uint32_t *) o->s;
+  for (int i = 0; i < HV_N_SIMD; ++i) {
+    for (int k = 0; k < 4; ++k) w[4*(4*(i/4) + k) + (i%4)] = s[k];
+    hv_random_jump(s);
+  }
+#endif
+}
+
+hv_size_t sNoise_init(SignalNoise *o, int seed) {
+  // the seeds of unseeded instances only need to differ, a race between contexts is harmless
+  static hv_uint32_t nextSeed = 1;
+  sNoise_seed(o, (seed != 0) ? (hv_uint32_t) seed : (nextSeed += 0x61C88647));
+  return 0;
+}
+
+void sNoise_onMessage(HeavyContextInterface *_c, SignalNoise *o, int letIn, const HvMessage *m) {
+  if (letIn == 0 && msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_seed) && msg_isFloat(m, 1)) {
+    sNoise_seed(o, (hv_uint32_t) (hv_int32_t) msg_getFloat(m, 1));
+  }
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _HEAVY_SIGNAL_NOISE_H_
+#define _HEAVY_SIGNAL_NOISE_H_
+
+#include "HvHeavyInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * White noise in [-1,1). Every lane runs its own xoshiro128+ generator (see hv_random_next()),
+ * spaced 2^64 steps apart, such that a whole vector is produced per step without any
+ * dependency between lanes.
+ */
+typedef struct SignalNoise {
+#if HV_SIMD_AVX
+  __m128i s[2][4]; // AVX has no 256-bit integer operations, each half holds four lanes
+#elif HV_SIMD_SSE
+  __m128i s[4];
+#elif HV_SIMD_NEON
+  uint32x4_t s[4];
+#else // HV_SIMD_NONE
+  hv_uint32_t s[4];
+#endif
+} SignalNoise;
+
+/**
+ * Instances with the same non-zero seed produce the same noise. With a seed of 0 every instance
+ * is given a different seed.
+ */
+hv_size_t sNoise_init(SignalNoise *o, int seed);
+
+// accepts "seed <f>" on the left inlet, like noise~ in Pd
+void sNoise_onMessage(HeavyContextInterface *_c, SignalNoise *o, int letIn, const HvMessage *m);
+
+#if HV_SIMD_AVX || HV_SIMD_SSE
+// returns the next four values of the generators in s, as floats in [-1,1)
+static inline __m128 __hv_noise_sse(__m128i *s) {
+  const __m128i x = _mm_add_epi32(s[0], s[3]);
+  const __m128i t = _mm_slli_epi32(s[1], 9);
+  s[2] = _mm_xor_si128(s[2], s[0]);
+  s[3] = _mm_xor_si128(s[3], s[1]);
+  s[1] = _mm_xor_si128(s[1], s[2]);
+  s[0] = _mm_xor_si128(s[0], s[3]);
+  s[2] = _mm_xor_si128(s[2], t);
+  s[3] = _mm_or_si128(_mm_slli_epi32(s[3], 11), _mm_srli_epi32(s[3], 21));
+
+  // the upper 23 bits become the mantissa of a float in [2,4)
+  return _mm_sub_ps(_mm_castsi128_ps(
+      _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x40000000))),
+      _mm_set1_ps(3.0f));
+}
+#endif
+
+static inline void __hv_noise_f(SignalNoise *o, hv_bOutf_t bOut) {
+#if HV_SIMD_AVX
+  const __m128 a = __hv_noise_sse(o->s[0]);
+  const __m128 b = __hv_noise_sse(o->s[1]);
+  *bOut = _mm256_insertf128_ps(_mm256_castps128_ps256(a), b, 1);
+#elif HV_SIMD_SSE
+  *bOut = __hv_noise_sse(o->s);
+#elif HV_SIMD_NEON
+  const uint32x4_t x = vaddq_u32(o->s[0], o->s[3]);
+  const uint32x4_t t = vshlq_n_u32(o->s[1], 9);
+  o->s[2] = veorq_u32(o->s[2], o->s[0]);
+  o->s[3] = veorq_u32(o->s[3], o->s[1]);
+  o->s[1] = veorq_u32(o->s[1], o->s[2]);
+  o->s[0] = veorq_u32(o->s[0], o->s[3]);
+  o->s[2] = veorq_u32(o->s[2], t);
+  o->s[3] = vsriq_n_u32(vshlq_n_u32(o->s[3], 11), o->s[3], 21);
+  *bOut = vsubq_f32(vreinterpretq_f32_u32(
+      vorrq_u32(vshrq_n_u32(x, 9), vdupq_n_u32(0x40000000))),
+      vdupq_n_f32(3.0f));
+#else // HV_SIMD_NONE
+  union { hv_uint32_t u; float f; } x;
+  x.u = (hv_random_next(o->s) >> 9) | 0x40000000;
+  *bOut = x.f - 3.0f;
+#endif
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // _HEAVY_SIGNAL_NOISE_H_
@@ -0,0 +1,313 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "HvSignalOscillator.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846 // in case math.h doesn't include this defintion
+#endif
+
+hv_size_t sOsc_init(SignalOscillator *o, double samplerate) {
+  o->f2inc = (float) (1.0/samplerate);
+  return sPhasor_init(&o->phasor, samplerate);
+}
+
+void sOsc_onMessage(HeavyContextInterface *_c, SignalOscillator *o, int letIn, const HvMessage *m) {
+  sPhasor_onMessage(_c, &o->phasor, letIn, m);
+}
+
+
+
+#if HV_APPLE
+#pragma mark - Wavetable
+#endif
+
+// A DFT of n complex values of any length. Lengths that are not powers of two are turned into a
+// convolution with a chirp, which is done with FFTs of a power-of-two length m (Bluestein's
+// algorithm). Everything that does not depend on the values is computed once.
+typedef struct WavetableDft {
+  int n;
+  int m; // the length of the FFTs
+  double *twr, *twi; // exp(-2*pi*i*k/m), for k < m/2
+  double *cr, *ci; // the chirp exp(-i*pi*k^2/n), for k < n
+  double *br, *bi; // the FFT of the conjugate chirp, which is symmetric around 0
+  double *ar, *ai;
+} WavetableDft;
+
+// In-place forward FFT of m complex values.
+static void sWavetable_fft(const WavetableDft *d, double *re, double *im) {
+  const int m = d->m;
+  for (int i = 1, j = 0; i < m; ++i) {
+    int bit = m >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      double t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+  for (int len = 2, step = m/2; len <= m; len <<= 1, step >>= 1) {
+    for (int i = 0; i < m; i += len) {
+      for (int k = 0; k < len/2; ++k) {
+        const double wr = d->twr[k*step];
+        const double wi = d->twi[k*step];
+        const int a = i + k;
+        const int b = a + len/2;
+        const double xr = re[b]*wr - im[b]*wi;
+        const double xi = re[b]*wi + im[b]*wr;
+        re[b] = re[a] - xr;
+        im[b] = im[a] - xi;
+        re[a] += xr;
+        im[a] += xi;
+      }
+    }
+  }
+}
+
+static void sWavetable_initDft(WavetableDft *d, int n) {
+  d->n = n;
+  d->m = 1;
+  while (d->m < n) d->m <<= 1;
+  if (d->m != n) while (d->m < 2*n-1) d->m <<= 1;
+  const int m = d->m;
+
+  d->twr = (double *) hv_malloc((m/2+1)*sizeof(double));
+  d->twi = (double *) hv_malloc((m/2+1)*sizeof(double));
+  hv_assert(d->twr != NULL && d->twi != NULL);
+  for (int k = 0; k < m/2; ++k) {
+    d->twr[k] = cos(-2.0*M_PI*k/m);
+    d->twi[k] = sin(-2.0*M_PI*k/m);
+  }
+
+  d->cr = d->ci = d->br = d->bi = d->ar = d->ai = NULL;
+  if (m == n) return;
+  d->cr = (double *) hv_malloc(n*sizeof(double));
+  d->ci = (double *) hv_malloc(n*sizeof(double));
+  d->br = (double *) hv_malloc(m*sizeof(double));
+  d->bi = (double *) hv_malloc(m*sizeof(double));
+  d->ar = (double *) hv_malloc(m*sizeof(double));
+  d->ai = (double *) hv_malloc(m*sizeof(double));
+  hv_assert(d->cr != NULL && d->ci != NULL && d->br != NULL && d->bi != NULL && d->ar != NULL && d->ai != NULL);
+  hv_memclear(d->br, m*sizeof(double));
+  hv_memclear(d->bi, m*sizeof(double));
+  for (int k = 0; k < n; ++k) {
+    // k^2 is wrapped to 2n, such that the chirp stays exact
+    const double a = -M_PI * (double) (((hv_uint64_t) k*k) % (2*n)) / n;
+    d->cr[k] = cos(a);
+    d->ci[k] = sin(a);
+    d->br[k] = d->cr[k];
+    d->bi[k] = -d->ci[k];
+    if (k > 0) {
+      d->br[m-k] = d->cr[k];
+      d->bi[m-k] = -d->ci[k];
+    }
+  }
+  sWavetable_fft(d, d->br, d->bi);
+}
+
+static void sWavetable_freeDft(WavetableDft *d) {
+  hv_free(d->ai);
+  hv_free(d->ar);
+  hv_free(d->bi);
+  hv_free(d->br);
+  hv_free(d->ci);
+  hv_free(d->cr);
+  hv_free(d->twi);
+  hv_free(d->twr);
+}
+
+// In-place DFT of the n values. The inverse is taken as the conjugate of the DFT of the conjugate,
+// and is not scaled.
+static void sWavetable_dft(const WavetableDft *d, double *re, double *im, bool inverse) {
+  const int n = d->n;
+  const int m = d->m;
+  if (inverse) for (int k = 0; k < n; ++k) im[k] = -im[k];
+  if (m == n) {
+    sWavetable_fft(d, re, im);
+  } else {
+    double *const ar = d->ar;
+    double *const ai = d->ai;
+    for (int k = 0; k < n; ++k) {
+      ar[k] = re[k]*d->cr[k] - im[k]*d->ci[k];
+      ai[k] = re[k]*d->ci[k] + im[k]*d->cr[k];
+    }
+    hv_memclear(ar+n, (m-n)*sizeof(double));
+    hv_memclear(ai+n, (m-n)*sizeof(double));
+    sWavetable_fft(d, ar, ai);
+    // multiplied by the FFT of the chirp, and conjugated for the inverse FFT
+    for (int k = 0; k < m; ++k) {
+      const double xr = ar[k]*d->br[k] - ai[k]*d->bi[k];
+      ai[k] = -(ar[k]*d->bi[k] + ai[k]*d->br[k]);
+      ar[k] = xr;
+    }
+    sWavetable_fft(d, ar, ai);
+    for (int k = 0; k < n; ++k) {
+      // the inverse FFT is the conjugate of the result, scaled by 1/m
+      const double xr = ar[k] / m;
+      const double xi = -ai[k] / m;
+      re[k] = xr*d->cr[k] - xi*d->ci[k];
+      im[k] = xr*d->ci[k] + xi*d->cr[k];
+    }
+  }
+  if (inverse) for (int k = 0; k < n; ++k) im[k] = -im[k];
+}
+
+static int sWavetable_getNumLevels(int length) {
+  int numLevels = 1;
+  for (int h = length/2; h > 1; h >>= 1) numLevels++;
+  return numLevels;
+}
+
+// the number of samples of the cycle that is played from a table of n samples
+static int sWavetable_getLength(hv_uint32_t n) {
+  if (n == 0) return 1;
+  return (n < HV_WAVETABLE_MAX_LENGTH) ? (int) n : HV_WAVETABLE_MAX_LENGTH;
+}
+
+// Builds the mip-maps of a cycle of n samples, played with the given length.
+static float *sWavetable_buildLevels(const float *x, int n, int length) {
+  const int numLevels = sWavetable_getNumLevels(length);
+  float *const levels = (float *) hv_arena_malloc(numLevels*(length+1)*sizeof(float));
+  hv_assert(levels != NULL);
+  if (n == 0) {
+    hv_memclear(levels, numLevels*(length+1)*sizeof(float));
+    return levels;
+  }
+
+  // the harmonics of the whole cycle
+  double *const spectrumRe = (double *) hv_malloc(n*sizeof(double));
+  double *const spectrumIm = (double *) hv_malloc(n*sizeof(double));
+  double *const re = (double *) hv_malloc(length*sizeof(double));
+  double *const im = (double *) hv_malloc(length*sizeof(double));
+  hv_assert(spectrumRe != NULL && spectrumIm != NULL && re != NULL && im != NULL);
+  for (int i = 0; i < n; ++i) {
+    spectrumRe[i] = x[i];
+    spectrumIm[i] = 0.0;
+  }
+  WavetableDft d;
+  sWavetable_initDft(&d, n);
+  sWavetable_dft(&d, spectrumRe, spectrumIm, false);
+  if (length != n) {
+    sWavetable_freeDft(&d);
+    sWavetable_initDft(&d, length);
+  }
+
+  // level l keeps the harmonics up to (length/2) >> l, the last one is a sinusoid. A shorter
+  // length than the table drops the harmonics that do not fit.
+  for (int l = 0; l < numLevels; ++l) {
+    const int maxHarmonic = (length/2) >> l;
+    hv_memclear(re, length*sizeof(double));
+    hv_memclear(im, length*sizeof(double));
+    re[0] = spectrumRe[0];
+    for (int k = 1; k <= maxHarmonic; ++k) {
+      // the positive and negative frequency of each harmonic, but Nyquist appears once
+      re[k] += spectrumRe[k];
+      im[k] += spectrumIm[k];
+      if (2*k != n) {
+        re[length-k] += spectrumRe[n-k];
+        im[length-k] += spectrumIm[n-k];
+      }
+    }
+    sWavetable_dft(&d, re, im, true);
+
+    float *const y = levels + l*(length+1);
+    for (int i = 0; i < length; ++i) y[i] = (float) (re[i] / n);
+    y[length] = y[0];
+  }
+
+  sWavetable_freeDft(&d);
+  hv_free(im);
+  hv_free(re);
+  hv_free(spectrumIm);
+  hv_free(spectrumRe);
+  return levels;
+}
+
+hv_size_t sWavetable_init(HeavyContextInterface *_c, SignalWavetable *o, HvTable *table, double samplerate) {
+  hv_size_t numBytes = sPhasor_init(&o->phasor, samplerate);
+  o->f2inc = (float) (1.0/samplerate);
+  o->table = table;
+  o->version = table->version;
+  o->length = sWavetable_getLength(hTable_getLength(table));
+  o->numLevels = sWavetable_getNumLevels(o->length);
+  o->levels = sWavetable_buildLevels(hTable_getBuffer(table), (int) hTable_getLength(table), o->length);
+  numBytes += o->numLevels*(o->length+1)*sizeof(float);
+  o->next = NULL;
+  hv_addWavetable(_c, o);
+  return numBytes;
+}
+
+void sWavetable_free(SignalWavetable *o) {
+  hv_arena_free(o->levels);
+}
+
+float *sWavetable_newLevels(SignalWavetable *o, hv_uint32_t *length) {
+  const hv_uint32_t version = o->table->version;
+  if (version == o->version) return NULL;
+  // a table that changes while the mip-maps are built has a new version, and is built again
+  const hv_uint32_t n = hTable_getLength(o->table);
+  *length = (hv_uint32_t) sWavetable_getLength(n);
+  float *const levels = sWavetable_buildLevels(hTable_getBuffer(o->table), (int) n, (int) *length);
+  o->version = version;
+  return levels;
+}
+
+float *sWavetable_swapLevels(SignalWavetable *o, float *levels, hv_uint32_t length) {
+  float *const oldLevels = o->levels;
+  o->levels = levels;
+  o->length = (int) length;
+  o->numLevels = sWavetable_getNumLevels(o->length);
+  return oldLevels;
+}
+
+void sWavetable_onMessage(HeavyContextInterface *_c, SignalWavetable *o, int letIn, const HvMessage *m) {
+  sPhasor_onMessage(_c, &o->phasor, letIn, m);
+}
+
+void __hv_wavetable_f(SignalWavetable *o, hv_bInf_t bIn, hv_bOutf_t bOut) {
+  hv_bufferf_t t, inc, k;
+  __hv_phasor_f(&o->phasor, bIn, &t);
+  __hv_osc_set_f(o->f2inc, &k);
+  __hv_mul_f(bIn, k, &inc);
+  __hv_abs_f(inc, &inc);
+
+  const float *const p = (float *) &t;
+  const float *const d = (float *) &inc;
+
+  // choose one level for the whole vector, from its highest frequency
+  float maxInc = d[0];
+  for (int i = 1; i < HV_N_SIMD; ++i) maxInc = hv_max_f(maxInc, d[i]);
+  int l = 0;
+  while ((l < o->numLevels-1) && ((o->length/2 >> l) * maxInc > 0.5f)) ++l;
+  const float *const y = o->levels + l*(o->length+1);
+
+  float z[HV_N_SIMD];
+  for (int i = 0; i < HV_N_SIMD; ++i) {
+    const float x = p[i] * o->length;
+    const int j = ((int) x < o->length) ? (int) x : o->length-1; // the phase may round up to 1
+    hv_assert(j >= 0);
+    z[i] = y[j] + (x - (float) j) * (y[j+1] - y[j]);
+  }
+#if HV_SIMD_AVX
+  *bOut = _mm256_loadu_ps(z);
+#elif HV_SIMD_SSE
+  *bOut = _mm_loadu_ps(z);
+#elif HV_SIMD_NEON
+  *bOut = vld1q_f32(z);
+#else // HV_SIMD_NONE
+  *bOut = z[0];
+#endif
+}
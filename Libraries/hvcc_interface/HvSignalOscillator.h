@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _HEAVY_SIGNAL_OSCILLATOR_H_
+#define _HEAVY_SIGNAL_OSCILLATOR_H_
+
+#include "HvHeavyInternal.h"
+#include "HvSignalPhasor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Band-limited oscillators driven by a SignalPhasor. The input is the frequency in Hz, as for
+ * __hv_phasor_f, and the phase can be reset through the right inlet in the same way.
+ *
+ * __hv_saw_f, __hv_square_f and __hv_triangle_f use PolyBLEP and PolyBLAMP corrections around
+ * each discontinuity of the naive waveform. They need no memory and are about as cheap as a few
+ * binops per vector. __hv_wavetable_f plays one cycle of a table from a set of mip-maps, each
+ * holding half the harmonics of the previous one, such that no harmonic above Nyquist is played.
+ */
+
+typedef struct SignalOscillator {
+  SignalPhasor phasor;
+  float f2inc; // frequency to phase increment per sample
+} SignalOscillator;
+
+/**
+ * The most samples that one cycle of a wavetable is played with. The harmonics of longer tables
+ * that do not fit are dropped, which only matters for frequencies below samplerate/length.
+ */
+#ifndef HV_WAVETABLE_MAX_LENGTH
+#define HV_WAVETABLE_MAX_LENGTH 8192
+#endif
+
+typedef struct SignalWavetable {
+  SignalPhasor phasor;
+  float f2inc;
+  int length; // the number of samples in one cycle
+  int numLevels; // the number of mip-maps
+  float *levels; // numLevels cycles, each followed by its first sample for interpolation
+  HvTable *table; // the table that the mip-maps are built from
+  hv_uint32_t version; // the version of the table when the last mip-maps were built
+  struct SignalWavetable *next; // the next wavetable of the context
+} SignalWavetable;
+
+hv_size_t sOsc_init(SignalOscillator *o, double samplerate);
+
+void sOsc_onMessage(HeavyContextInterface *_c, SignalOscillator *o, int letIn, const HvMessage *m);
+
+/**
+ * Builds the mip-maps from the current contents of the table, which holds one cycle of the
+ * waveform, and adds the wavetable to the context. Whenever the table gets a new buffer or the
+ * host sets its length, hv_processTableResizes() builds new mip-maps on its thread, and they are
+ * swapped in at the start of a later block. Samples that the patch writes into the table are not
+ * heard. Building the mip-maps costs O(length*log(length)) for the length of the table, and they
+ * take up to 13*(HV_WAVETABLE_MAX_LENGTH+1) floats.
+ */
+hv_size_t sWavetable_init(HeavyContextInterface *_c, SignalWavetable *o, HvTable *table, double samplerate);
+
+/** The wavetable must not be freed before its context. */
+void sWavetable_free(SignalWavetable *o);
+
+/**
+ * Builds mip-maps from the current contents of the table, to be swapped in with
+ * sWavetable_swapLevels(). Does not modify what the wavetable plays, so it can be called on
+ * another thread while the wavetable is in use.
+ * @return  The mip-maps, or NULL if the table has not changed since the last ones were built.
+ */
+float *sWavetable_newLevels(SignalWavetable *o, hv_uint32_t *length);
+
+/**
+ * Replaces the mip-maps with ones from sWavetable_newLevels().
+ * @return  The old mip-maps, which the caller must release with hTable_freeBuffer().
+ */
+float *sWavetable_swapLevels(SignalWavetable *o, float *levels, hv_uint32_t length);
+
+void sWavetable_onMessage(HeavyContextInterface *_c, SignalWavetable *o, int letIn, const HvMessage *m);
+
+void __hv_wavetable_f(SignalWavetable *o, hv_bInf_t bIn, hv_bOutf_t bOut);
+
+
+
+#if HV_APPLE
+#pragma mark - PolyBLEP
+#endif
+
+// Returns the distances to the next and the previous discontinuity of the phase bIn, in units of
+// the phase increment bInc and inverted such that they are 1 at the discontinuity and reach 0 one
+// sample away from it.
+static inline void __hv_polyblep_dist_f(hv_bInf_t bIn, hv_bInf_t bInc,
+    hv_bOutf_t bOutNext, hv_bOutf_t bOutPrev) {
+  hv_bufferf_t one, zero, dt, rdt, a, b;
+  __hv_zero_f(&zero);
+#if HV_SIMD_AVX
+  one = _mm256_set1_ps(1.0f);
+  dt = _mm256_set1_ps(0.5f);
+  a = _mm256_set1_ps(1e-6f);
+#elif HV_SIMD_SSE
+  one = _mm_set1_ps(1.0f);
+  dt = _mm_set1_ps(0.5f);
+  a = _mm_set1_ps(1e-6f);
+#elif HV_SIMD_NEON
+  one = vdupq_n_f32(1.0f);
+  dt = vdupq_n_f32(0.5f);
+  a = vdupq_n_f32(1e-6f);
+#else // HV_SIMD_NONE
+  one = 1.0f;
+  dt = 0.5f;
+  a = 1e-6f;
+#endif
+  // the corrections of neighbouring discontinuities must not overlap
+  __hv_abs_f(bInc, &b);
+  __hv_min_f(b, dt, &dt);
+  __hv_max_f(dt, a, &dt);
+  __hv_div_f(one, dt, &rdt);
+
+  __hv_sub_f(one, bIn, &b);  // 1-t
+  __hv_mul_f(b, rdt, &b);
+  __hv_sub_f(one, b, &b);
+  __hv_max_f(b, zero, bOutNext); // max(1 - (1-t)/dt, 0)
+  __hv_mul_f(bIn, rdt, &a);
+  __hv_sub_f(one, a, &a);
+  __hv_max_f(a, zero, bOutPrev); // max(1 - t/dt, 0)
+}
+
+// Returns the PolyBLEP residual of a unit step at phase 0 (b^2 - a^2 with the distances above).
+static inline void __hv_polyblep_f(hv_bInf_t bIn, hv_bInf_t bInc, hv_bOutf_t bOut) {
+  hv_bufferf_t a, b;
+  __hv_polyblep_dist_f(bIn, bInc, &b, &a);
+  __hv_mul_f(a, a, &a);
+  __hv_fms_f(b, b, a, bOut);
+}
+
+// Returns the PolyBLAMP residual of a unit change of slope per sample at phase 0 ((a^3 + b^3)/3).
+static inline void __hv_polyblamp_f(hv_bInf_t bIn, hv_bInf_t bInc, hv_bOutf_t bOut) {
+  hv_bufferf_t a, b, c;
+  __hv_polyblep_dist_f(bIn, bInc, &b, &a);
+  __hv_mul_f(a, a, &c);
+  __hv_mul_f(a, c, &a);
+  __hv_mul_f(b, b, &c);
+  __hv_fma_f(b, c, a, &a);
+#if HV_SIMD_AVX
+  *bOut = _mm256_mul_ps(a, _mm256_set1_ps(1.0f/3.0f));
+#elif HV_SIMD_SSE
+  *bOut = _mm_mul_ps(a, _mm_set1_ps(1.0f/3.0f));
+#elif HV_SIMD_NEON
+  *bOut = vmulq_n_f32(a, 1.0f/3.0f);
+#else // HV_SIMD_NONE
+  *bOut = a * (1.0f/3.0f);
+#endif
+}
+
+// Returns bIn + 0.5, wrapped to [0,1).
+static inline void __hv_phase_half_f(hv_bInf_t bIn, hv_bOutf_t bOut) {
+  hv_bufferf_t h, x;
+#if HV_SIMD_AVX
+  h = _mm256_set1_ps(0.5f);
+#elif HV_SIMD_SSE
+  h = _mm_set1_ps(0.5f);
+#elif HV_SIMD_NEON
+  h = vdupq_n_f32(0.5f);
+#else // HV_SIMD_NONE
+  h = 0.5f;
+#endif
+  __hv_add_f(bIn, h, &x);
+  __hv_floor_f(x, &h);
+  __hv_sub_f(x, h, bOut);
+}
+
+// Returns a vector with all elements set to x.
+static inline void __hv_osc_set_f(float x, hv_bOutf_t bOut) {
+#if HV_SIMD_AVX
+  *bOut = _mm256_set1_ps(x);
+#elif HV_SIMD_SSE
+  *bOut = _mm_set1_ps(x);
+#elif HV_SIMD_NEON
+  *bOut = vdupq_n_f32(x);
+#else // HV_SIMD_NONE
+  *bOut = x;
+#endif
+}
+
+// Rising saw in [-1,1], 2t - 1.
+static inline void __hv_saw_f(SignalOscillator *o, hv_bInf_t bIn, hv_bOutf_t bOut) {
+  hv_bufferf_t t, inc, k, x;
+  __hv_phasor_f(&o->phasor, bIn, &t);
+  __hv_osc_set_f(o->f2inc, &k);
+  __hv_mul_f(bIn, k, &inc);
+
+  __hv_osc_set_f(2.0f, &k);
+  __hv_osc_set_f(1.0f, &x);
+  __hv_fms_f(t, k, x, &x); // naive saw
+  __hv_polyblep_f(t, inc, &t);
+  __hv_sub_f(x, t, bOut); // the saw falls by 2 at t = 0
+}
+
+// Square in [-1,1], high for the first half of the cycle.
+static inline void __hv_square_f(SignalOscillator *o, hv_bInf_t bIn, hv_bOutf_t bOut) {
+  hv_bufferf_t t, u, inc, k, x, y;
+  __hv_phasor_f(&o->phasor, bIn, &t);
+  __hv_osc_set_f(o->f2inc, &k);
+  __hv_mul_f(bIn, k, &inc);
+
+  __hv_osc_set_f(0.5f, &k);
+  __hv_gte_f(t, k, &y);
+  __hv_osc_set_f(2.0f, &k);
+  __hv_and_f(y, k, &y);
+  __hv_osc_set_f(1.0f, &x);
+  __hv_sub_f(x, y, &x); // naive square
+
+  __hv_phase_half_f(t, &u);
+  __hv_polyblep_f(t, inc, &t);
+  __hv_polyblep_f(u, inc, &u);
+  __hv_add_f(x, t, &x); // rises by 2 at t = 0
+  __hv_sub_f(x, u, bOut); // falls by 2 at t = 0.5
+}
+
+// Triangle in [-1,1], 4|t - 0.5| - 1. It starts at 1 like cos~.
+static inline void __hv_triangle_f(SignalOscillator *o, hv_bInf_t bIn, hv_bOutf_t bOut) {
+  hv_bufferf_t t, u, inc, k, x;
+  __hv_phasor_f(&o->phasor, bIn, &t);
+  __hv_osc_set_f(o->f2inc, &k);
+  __hv_mul_f(bIn, k, &inc);
+
+  __hv_osc_set_f(0.5f, &k);
+  __hv_sub_f(t, k, &x);
+  __hv_abs_f(x, &x);
+  __hv_osc_set_f(4.0f, &k);
+  __hv_mul_f(x, k, &x);
+  __hv_osc_set_f(1.0f, &k);
+  __hv_sub_f(x, k, &x); // naive triangle
+
+  // the slope changes by 8 per cycle, i.e. by 8*|inc| per sample, at t = 0 and t = 0.5
+  __hv_phase_half_f(t, &u);
+  __hv_polyblamp_f(t, inc, &t);
+  __hv_polyblamp_f(u, inc, &u);
+  __hv_sub_f(u, t, &u);
+  __hv_abs_f(inc, &inc);
+  __hv_osc_set_f(4.0f, &k);
+  __hv_mul_f(inc, k, &inc);
+  __hv_fma_f(u, inc, x, bOut);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // _HEAVY_SIGNAL_OSCILLATOR_H_
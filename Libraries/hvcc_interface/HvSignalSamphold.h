@@ -30,216 +30,69 @@ typedef struct SignalSamphold {
 hv_size_t sSamphold_init(SignalSamphold *o);
 
 static inline void __hv_samphold_f(SignalSamphold *o, hv_bInf_t bIn0, hv_bInf_t bIn1, hv_bOutf_t bOut) {
+  // Each lane takes the input of the last triggered lane at or before it, or the held value if
+  // there is none. The triggers and their inputs are propagated towards the later lanes in
+  // log2(HV_N_SIMD) steps, such that no branch depends on the trigger pattern.
 #if HV_SIMD_AVX
-  hv_assert(0); // __hv_samphold_f() not implemented
+  // NOTE: lanes are selected with and/andnot rather than _mm256_blendv_ps, which some compilers
+  // turn into scalar branches when AVX2 is not available. The triggers must therefore be full
+  // lane masks, as produced by the comparison operators.
+  const __m256 z = _mm256_setzero_ps();
+  __m256 x = bIn0;
+  __m256 t = bIn1;
+
+  // shift by one lane, then by two lanes, within each half
+  __m256 x1 = _mm256_permute_ps(x, _MM_SHUFFLE(2,1,0,0));
+  __m256 t1 = _mm256_blend_ps(_mm256_permute_ps(t, _MM_SHUFFLE(2,1,0,0)), z, 0x11);
+  x = _mm256_or_ps(_mm256_and_ps(t, x), _mm256_andnot_ps(t, x1));
+  t = _mm256_or_ps(t, t1);
+  x1 = _mm256_permute_ps(x, _MM_SHUFFLE(1,0,0,0));
+  t1 = _mm256_blend_ps(_mm256_permute_ps(t, _MM_SHUFFLE(1,0,0,0)), z, 0x33);
+  x = _mm256_or_ps(_mm256_and_ps(t, x), _mm256_andnot_ps(t, x1));
+  t = _mm256_or_ps(t, t1);
+
+  // the last lane of the lower half carries over into the upper half
+  x1 = _mm256_permute_ps(x, _MM_SHUFFLE(3,3,3,3));
+  t1 = _mm256_permute_ps(t, _MM_SHUFFLE(3,3,3,3));
+  x1 = _mm256_permute2f128_ps(x1, x1, 0x08);
+  t1 = _mm256_permute2f128_ps(t1, t1, 0x08);
+  x = _mm256_or_ps(_mm256_and_ps(t, x), _mm256_andnot_ps(t, x1));
+  t = _mm256_or_ps(t, t1);
+
+  *bOut = _mm256_or_ps(_mm256_and_ps(t, x), _mm256_andnot_ps(t, o->s));
+  x = _mm256_permute_ps(*bOut, _MM_SHUFFLE(3,3,3,3));
+  o->s = _mm256_permute2f128_ps(x, x, 0x11);
 #elif HV_SIMD_SSE
-  switch (_mm_movemask_ps(bIn1)) {
-    default:
-    case 0x0: *bOut = o->s; break;
-    case 0x1: {
-      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(0,0,0,0));
-      o->s = *bOut;
-      break;
-    }
-    case 0x2: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(1,1,1,1));
-      *bOut = _mm_blend_ps(o->s, x, 0xE);
-      o->s = x;
-      break;
-    }
-    case 0x3: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(1,1,1,1));
-      *bOut = _mm_blend_ps(bIn0, x, 0xC);
-      o->s = x;
-      break;
-    }
-    case 0x4: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
-      *bOut = _mm_blend_ps(o->s, x, 0xC);
-      o->s = x;
-      break;
-    }
-    case 0x5: {
-      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,0,0));
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
-      break;
-    }
-    case 0x6: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,1,0));
-      *bOut = _mm_blend_ps(o->s, x, 0xE);
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
-      break;
-    }
-    case 0x7: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
-      *bOut = _mm_blend_ps(bIn0, x, 0x8);
-      o->s = x;
-      break;
-    }
-    case 0x8: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      *bOut = _mm_blend_ps(o->s, x, 0x8);
-      o->s = x;
-      break;
-    }
-    case 0x9: {
-      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,0,0,0));
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-    case 0xA: {
-      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,1,1,0));
-      *bOut = _mm_blend_ps(o->s, x, 0xE);
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-    case 0xB: {
-      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,1,1,0));
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-    case 0xC: {
-      *bOut = _mm_blend_ps(o->s, bIn0, 0xC);
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-    case 0xD: {
-      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,2,0,0));
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-    case 0xE: {
-      *bOut = _mm_blend_ps(o->s, bIn0, 0xE);
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-    case 0xF: {
-      *bOut = bIn0;
-      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
-      break;
-    }
-  }
+  __m128 x = bIn0;
+  __m128 t = bIn1;
+
+  __m128 x1 = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4));
+  __m128 t1 = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(t), 4));
+  x = _mm_blendv_ps(x1, x, t);
+  t = _mm_or_ps(t, t1);
+  x1 = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8));
+  t1 = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(t), 8));
+  x = _mm_blendv_ps(x1, x, t);
+  t = _mm_or_ps(t, t1);
+
+  *bOut = _mm_blendv_ps(o->s, x, t);
+  o->s = _mm_shuffle_ps(*bOut, *bOut, _MM_SHUFFLE(3,3,3,3));
 #elif HV_SIMD_NEON
-  uint32x4_t mmA = vandq_u32(
-      vreinterpretq_u32_f32(bIn1), (uint32x4_t) {0x1, 0x2, 0x4, 0x8}); // [0 1 2 3]
-  uint32x4_t mmB = vextq_u32(mmA, mmA, 2);                             // [2 3 0 1]
-  uint32x4_t mmC = vorrq_u32(mmA, mmB);                                // [0+2 1+3 0+2 1+3]
-  uint32x4_t mmD = vextq_u32(mmC, mmC, 3);                             // [1+3 0+2 1+3 0+2]
-  uint32x4_t mmE = vorrq_u32(mmC, mmD);                                // [0+1+2+3 ...]
-  uint32_t movemask = vgetq_lane_u32(mmE, 0);
-  switch (movemask) {
-    default:
-    case 0x0: *bOut = o->s; break;
-    case 0x1: {
-      *bOut = vdupq_n_f32(vgetq_lane_f32(bIn0,0));
-      o->s = *bOut;
-      break;
-    }
-    case 0x2: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,1));
-      *bOut = vextq_f32(o->s, x, 3);
-      o->s = x;
-      break;
-    }
-    case 0x3: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,1));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0xFFFFFFFF, 0x0, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0x0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF})));
-      o->s = x;
-      break;
-    }
-    case 0x4: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,2));
-      *bOut = vextq_f32(o->s, x, 2);
-      o->s = x;
-      break;
-    }
-    case 0x5: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,0));
-      const float32x4_t y = vdupq_n_f32(vgetq_lane_f32(bIn0,2));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(y), (uint32x4_t) {0x0, 0x0, 0xFFFFFFFF, 0xFFFFFFFF})));
-      o->s = y;
-    }
-    case 0x6: {
-      const float32x4_t y = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      float32x4_t z = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(o->s), (uint32x4_t) {0xFFFFFFFF, 0x0, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0x0, 0xFFFFFFFF, 0xFFFFFFFF, 0x0})));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(z), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(y), (uint32x4_t) {0x0, 0x0, 0x0, 0xFFFFFFFF})));
-      o->s = y;
-    }
-    case 0x7: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,2));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0x0, 0x0, 0xFFFFFFFF, 0xFFFFFFFF})));
-      o->s = x;
-      break;
-    }
-    case 0x8: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      *bOut = vextq_f32(o->s, x, 1);
-      o->s = x;
-      break;
-    }
-    case 0x9: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,0));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0x0, 0x0, 0x0, 0xFFFFFFFF})));
-      o->s = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-    }
-    case 0xA: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,1));
-      const float32x4_t y = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      float32x4_t z = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(o->s), (uint32x4_t) {0xFFFFFFFF, 0x0, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0x0, 0xFFFFFFFF, 0xFFFFFFFF, 0x0})));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(z), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(y), (uint32x4_t) {0x0, 0x0, 0x0, 0xFFFFFFFF})));
-      o->s = y;
-    }
-    case 0xB: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,1));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0x0, 0xFFFFFFFF}),
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0x0, 0x0, 0xFFFFFFFF, 0x0})));
-      o->s = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      break;
-    }
-    case 0xC: {
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(o->s), (uint32x4_t) {0xFFFFFFFF, 0xFFFFFFFF, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0x0, 0x0, 0xFFFFFFFF, 0xFFFFFFFF})));
-      o->s = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      break;
-    }
-    case 0xD: {
-      const float32x4_t x = vdupq_n_f32(vgetq_lane_f32(bIn0,0));
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0xFFFFFFFF, 0x0, 0xFFFFFFFF, 0xFFFFFFFF}),
-          vandq_u32(vreinterpretq_u32_f32(x), (uint32x4_t) {0x0, 0xFFFFFFFF, 0x0, 0x0})));
-      o->s = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-    }
-    case 0xE: {
-      *bOut = vreinterpretq_f32_u32(vorrq_u32(
-          vandq_u32(vreinterpretq_u32_f32(o->s), (uint32x4_t) {0xFFFFFFFF, 0x0, 0x0, 0x0}),
-          vandq_u32(vreinterpretq_u32_f32(bIn0), (uint32x4_t) {0x0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF})));
-      o->s = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      break;
-    }
-    case 0xF: {
-      *bOut = bIn0;
-      o->s = vdupq_n_f32(vgetq_lane_f32(bIn0,3));
-      break;
-    }
-  }
+  const float32x4_t z = vdupq_n_f32(0.0f);
+  float32x4_t x = bIn0;
+  uint32x4_t t = vreinterpretq_u32_f32(bIn1);
+
+  float32x4_t x1 = vextq_f32(z, x, 3);
+  uint32x4_t t1 = vreinterpretq_u32_f32(vextq_f32(z, vreinterpretq_f32_u32(t), 3));
+  x = vbslq_f32(t, x, x1);
+  t = vorrq_u32(t, t1);
+  x1 = vextq_f32(z, x, 2);
+  t1 = vreinterpretq_u32_f32(vextq_f32(z, vreinterpretq_f32_u32(t), 2));
+  x = vbslq_f32(t, x, x1);
+  t = vorrq_u32(t, t1);
+
+  *bOut = vbslq_f32(t, x, o->s);
+  o->s = vdupq_n_f32(vgetq_lane_f32(*bOut, 3));
 #else // HV_SIMD_NONE
   if (bIn1 != 0.0f) o->s = bIn0;
   *bOut = o->s;
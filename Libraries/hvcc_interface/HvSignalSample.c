@@ -16,20 +16,20 @@
 
 #include "HvSignalSample.h"
 
-#define __HV_SAMPLE_NULL -1
-
 hv_size_t sSample_init(SignalSample *o) {
-  o->i = __HV_SAMPLE_NULL;
+  o->i = 0;
+  o->pending = false;
   return 0;
 }
 
 void sSample_onMessage(HeavyContextInterface *_c, SignalSample *o, int letIndex, const HvMessage *m) {
   o->i = msg_getTimestamp(m);
+  o->pending = true;
 }
 
 void __hv_sample_f(HeavyContextInterface *_c, SignalSample *o, hv_bInf_t bIn,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
-  if (o->i != __HV_SAMPLE_NULL) {
+  if (o->pending) {
 
 #if HV_SIMD_AVX || HV_SIMD_SSE
     const float *const b = (float *) &bIn;
@@ -44,6 +44,6 @@ void __hv_sample_f(HeavyContextInterface *_c, SignalSample *o, hv_bInf_t bIn,
     hv_uint32_t ts = (o->i + HV_N_SIMD) & ~HV_N_SIMD_MASK; // start of next block
     msg_initWithFloat(n, ts, out);
     hv_scheduleMessageForObject(_c, n, sendMessage, 0);
-    o->i = __HV_SAMPLE_NULL; // reset the index
+    o->pending = false;
   }
 }
@@ -25,6 +25,7 @@ extern "C" {
 
 typedef struct SignalSample {
   hv_uint32_t i; // timestamp at which to get sample
+  bool pending; // true if a sample has been requested, every timestamp is valid once the clock wraps
 } SignalSample;
 
 hv_size_t sSample_init(SignalSample *o);
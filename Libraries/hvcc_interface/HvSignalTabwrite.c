@@ -34,7 +34,7 @@ void sTabwrite_onMessage(HeavyContextInterface *_c, SignalTabwrite *o, int letIn
           break;
         }
         case HV_MSG_SYMBOL: {
-          if (msg_compareSymbol(m, 0, "stop")) {
+          if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_stop)) {
             o->head = HV_TABWRITE_STOPPED;
           }
           break;
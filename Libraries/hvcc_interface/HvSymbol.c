@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "HvSymbol.h"
+
+#include <stddef.h>
+
+// must be a power of two
+#define HV_SYMBOL_NUM_BUCKETS 1024
+
+HvSymbol **hv_symbolChunks[HV_SYMBOL_MAX_CHUNKS];
+
+// symbols are only ever added, so they can be looked up without the lock, which only serialises writers
+static HvSymbol *volatile buckets[HV_SYMBOL_NUM_BUCKETS];
+static volatile hv_uint32_t numSymbols = 0;
+static hv_atomic_bool symbolsLock;
+
+static const char *builtinNames[HV_NUM_BUILTIN_SYMBOLS] = {
+#define HV_SYMBOL_NAME(_s) #_s,
+  HV_BUILTIN_SYMBOLS(HV_SYMBOL_NAME)
+#undef HV_SYMBOL_NAME
+};
+
+static HvSymbol *hSymbol_lookup(const char *s, hv_uint32_t hash) {
+  HvSymbol *sym = buckets[hash & (HV_SYMBOL_NUM_BUCKETS-1)];
+  while (sym != NULL && !((sym->hash == hash) && !hv_strcmp(sym->name, s))) sym = sym->next;
+  return sym;
+}
+
+static HvSymbol *hSymbol_new(const char *s, hv_uint32_t hash) {
+  // hv_malloc may require the size to be a multiple of its alignment
+  const hv_size_t len = (hv_size_t) hv_strlen(s);
+  const hv_size_t numBytes = (offsetof(HvSymbol, name) + len + 1 + 31) & ~((hv_size_t) 31);
+  HvSymbol *sym = (HvSymbol *) hv_malloc(numBytes);
+  hv_assert(sym != NULL);
+  sym->next = NULL;
+  sym->hash = hash;
+  sym->id = HV_SYMBOL_NONE;
+  hv_memcpy(sym->name, s, len + 1);
+  return sym;
+}
+
+// must be called with the lock held, returns the symbol that ended up in the table,
+// or NULL if the table already holds maxSymbols
+static HvSymbol *hSymbol_insert(HvSymbol *sym, hv_uint32_t maxSymbols) {
+  HvSymbol *existing = hSymbol_lookup(sym->name, sym->hash);
+  if (existing != NULL) return existing;
+
+  if (numSymbols >= maxSymbols) return NULL;
+  const hv_uint32_t chunk = numSymbols >> HV_SYMBOL_CHUNK_SIZE_LOG2;
+  if (hv_symbolChunks[chunk] == NULL) {
+    // rare enough to allocate with the lock held
+    hv_symbolChunks[chunk] = (HvSymbol **) hv_malloc(HV_SYMBOL_CHUNK_SIZE * sizeof(HvSymbol *));
+    if (hv_symbolChunks[chunk] == NULL) return NULL;
+  }
+  sym->id = numSymbols;
+  hv_symbolChunks[chunk][sym->id & (HV_SYMBOL_CHUNK_SIZE-1)] = sym;
+
+  HvSymbol *volatile *bucket = buckets + (sym->hash & (HV_SYMBOL_NUM_BUCKETS-1));
+  sym->next = *bucket;
+  // the symbol and its chunk entry must be complete before readers can find it
+  hv_sfence();
+  *bucket = sym;
+  numSymbols = sym->id + 1;
+  return sym;
+}
+
+// must be called with the lock held. The builtins get the first ids, in the order of HvBuiltinSymbol
+static void hSymbol_insertBuiltins(void) {
+  if (numSymbols > 0) return;
+  for (int i = 0; i < HV_NUM_BUILTIN_SYMBOLS; ++i) {
+    hSymbol_insert(hSymbol_new(builtinNames[i], hv_string_to_hash(builtinNames[i])), HV_SYMBOL_MAX_CHUNKS * HV_SYMBOL_CHUNK_SIZE);
+  }
+}
+
+void hSymbol_init(void) {
+  HV_SPINLOCK_ACQUIRE(symbolsLock);
+  hSymbol_insertBuiltins();
+  HV_SPINLOCK_RELEASE(symbolsLock);
+}
+
+hv_uint32_t hSymbol_find(const char *s) {
+  hv_assert(s != NULL);
+  HvSymbol *sym = hSymbol_lookup(s, hv_string_to_hash(s));
+  return (sym != NULL) ? sym->id : HV_SYMBOL_NONE;
+}
+
+static hv_uint32_t hSymbol_internWithLimit(const char *s, hv_uint32_t maxSymbols) {
+  hv_assert(s != NULL);
+  if (numSymbols == 0) hSymbol_init();
+  const hv_uint32_t hash = hv_string_to_hash(s);
+  HvSymbol *sym = hSymbol_lookup(s, hash);
+  if (sym != NULL) return sym->id;
+
+  // allocate outside of the lock, another thread may intern the same string in the meantime
+  HvSymbol *newSym = hSymbol_new(s, hash);
+  HV_SPINLOCK_ACQUIRE(symbolsLock);
+  sym = hSymbol_insert(newSym, maxSymbols);
+  HV_SPINLOCK_RELEASE(symbolsLock);
+  if (sym != newSym) hv_free(newSym);
+  return (sym != NULL) ? sym->id : HV_SYMBOL_NONE;
+}
+
+hv_uint32_t hSymbol_intern(const char *s) {
+  return hSymbol_internWithLimit(s, HV_SYMBOL_MAX_CHUNKS * HV_SYMBOL_CHUNK_SIZE - HV_SYMBOL_NUM_RESERVED);
+}
+
+hv_uint32_t hSymbol_internLiteral(const char *s) {
+  const hv_uint32_t id = hSymbol_internWithLimit(s, HV_SYMBOL_MAX_CHUNKS * HV_SYMBOL_CHUNK_SIZE);
+  hv_assert((id != HV_SYMBOL_NONE) && "The symbol table is full, even the ids reserved for patches.");
+  return id;
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2014-2018 Enzien Audio Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef _HEAVY_SYMBOL_H_
+#define _HEAVY_SYMBOL_H_
+
+#include "HvUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Symbols are interned into a table that is shared by all contexts. Every string is stored once and
+ * never released, and messages only carry its 32-bit id. Two symbols are equal if and only if their
+ * ids are equal, and the hash of a symbol is computed once when it is interned. The builtin symbols
+ * are interned first, so their ids are known at compile time. The table holds a fixed number of
+ * symbols, so every distinct string a host sends takes up one of them for good.
+ */
+typedef struct HvSymbol {
+  struct HvSymbol *next; // the next symbol in the same bucket
+  hv_uint32_t hash;
+  hv_uint32_t id;
+  char name[1]; // the string, allocated along with the symbol
+} HvSymbol;
+
+// symbols are stored in chunks that are never moved, so they can be read without taking a lock
+#define HV_SYMBOL_CHUNK_SIZE_LOG2 10
+#define HV_SYMBOL_CHUNK_SIZE (1 << HV_SYMBOL_CHUNK_SIZE_LOG2)
+#define HV_SYMBOL_MAX_CHUNKS 1024
+
+// the last chunk of ids is kept for the string literals of patches (see hSymbol_internLiteral()), so
+// that strings from the host cannot fill the table before a patch is loaded
+#define HV_SYMBOL_NUM_RESERVED HV_SYMBOL_CHUNK_SIZE
+
+// symbols that the runtime compares against while processing messages. Objects must use these rather
+// than string literals, so that the audio thread never hashes or interns a string
+#define HV_BUILTIN_SYMBOLS(_X) \
+  _X(bang) _X(clear) _X(currentTime) _X(float) _X(flush) _X(head) _X(lane) _X(length) _X(mirror) \
+  _X(numInputChannels) _X(numOutputChannels) _X(resize) _X(samplerate) _X(seed) _X(size) \
+  _X(stop) _X(substeps) _X(table)
+
+typedef enum HvBuiltinSymbol {
+#define HV_SYMBOL_ENUM(_s) HV_SYMBOL_##_s,
+  HV_BUILTIN_SYMBOLS(HV_SYMBOL_ENUM)
+#undef HV_SYMBOL_ENUM
+  HV_NUM_BUILTIN_SYMBOLS
+} HvBuiltinSymbol;
+
+// returned by hSymbol_find() for strings that have never been interned
+#define HV_SYMBOL_NONE 0xFFFFFFFF
+
+extern HvSymbol **hv_symbolChunks[HV_SYMBOL_MAX_CHUNKS];
+
+/** Interns the builtin symbols. May be called any number of times. */
+void hSymbol_init(void);
+
+/**
+ * Returns the id of the string, adding it to the table if it is new.
+ * Only a new symbol takes a lock and allocates memory. Returns HV_SYMBOL_NONE if the table is full,
+ * not counting the ids reserved for the literals of patches.
+ */
+hv_uint32_t hSymbol_intern(const char *s);
+
+/**
+ * Returns the id of a string literal of a patch, like hSymbol_intern() but also using the reserved ids.
+ * Generated code interns all of its literals with this when the patch is loaded, so that processing
+ * only ever compares ids.
+ */
+hv_uint32_t hSymbol_internLiteral(const char *s);
+
+/** Returns the id of the string, or HV_SYMBOL_NONE if it has never been interned. Never takes a lock. */
+hv_uint32_t hSymbol_find(const char *s);
+
+static inline const HvSymbol *hSymbol_get(hv_uint32_t id) {
+  return hv_symbolChunks[id >> HV_SYMBOL_CHUNK_SIZE_LOG2][id & (HV_SYMBOL_CHUNK_SIZE-1)];
+}
+
+static inline const char *hSymbol_getName(hv_uint32_t id) {
+  return hSymbol_get(id)->name;
+}
+
+/** Returns the hash of a symbol, without looking at its characters. */
+static inline hv_uint32_t hSymbol_getHash(hv_uint32_t id) {
+  return hSymbol_get(id)->hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HEAVY_SYMBOL_H_
@@ -15,7 +15,7 @@
  */
 
 #include "HvTable.h"
-#include "HvMessage.h"
+#include "HvHeavyInternal.h"
 
 hv_size_t hTable_init(HvTable *o, int length) {
   o->length = length;
@@ -24,8 +24,16 @@ hv_size_t hTable_init(HvTable *o, int length) {
   // add an extra length for mirroring
   o->allocated = o->size + HV_N_SIMD;
   o->head = 0;
+  o->requestedLength = length;
+  o->resizing = false;
+  o->resizeSerial = 0;
+  o->nextPendingResize = NULL;
+  o->sendResized = NULL;
+  o->constant = false;
+  o->borrowed = false;
+  o->version = 0;
   hv_size_t numBytes = o->allocated * sizeof(float);
-  o->buffer = (float *) hv_malloc(numBytes);
+  o->buffer = (float *) hv_arena_malloc(numBytes);
   hv_assert(o->buffer != NULL);
   hv_memclear(o->buffer, numBytes);
   return numBytes;
@@ -36,8 +44,16 @@ hv_size_t hTable_initWithData(HvTable *o, int length, const float *data) {
   o->size = (length + HV_N_SIMD_MASK) & ~HV_N_SIMD_MASK;
   o->allocated = o->size + HV_N_SIMD;
   o->head = 0;
-  hv_size_t numBytes = o->size * sizeof(float);
-  o->buffer = (float *) hv_malloc(numBytes);
+  o->requestedLength = length;
+  o->resizing = false;
+  o->resizeSerial = 0;
+  o->nextPendingResize = NULL;
+  o->sendResized = NULL;
+  o->constant = false;
+  o->borrowed = false;
+  o->version = 0;
+  hv_size_t numBytes = o->allocated * sizeof(float); // including the mirror
+  o->buffer = (float *) hv_arena_malloc(numBytes);
   hv_assert(o->buffer != NULL);
   hv_memclear(o->buffer, numBytes);
   hv_memcpy(o->buffer, data, length*sizeof(float));
@@ -50,61 +66,97 @@ hv_size_t hTable_initWithFinalData(HvTable *o, int length, float *data) {
   o->allocated = length;
   o->buffer = data;
   o->head = 0;
+  o->requestedLength = length;
+  o->resizing = false;
+  o->resizeSerial = 0;
+  o->nextPendingResize = NULL;
+  o->sendResized = NULL;
+  o->constant = false;
+  o->borrowed = false;
+  o->version = 0;
+  return 0;
+}
+
+hv_size_t hTable_initWithConstData(HvTable *o, int length, const float *data) {
+  hv_assert((((hv_uintptr_t) (const void *) data) & ((HV_N_SIMD*sizeof(float))-1)) == 0); // aligned for SIMD access
+  o->length = length;
+  o->size = hTable_sizeForLength(length);
+  o->allocated = o->size + HV_N_SIMD;
+  o->buffer = (float *) data; // never written to while the table is constant
+  o->head = 0;
+  o->requestedLength = length;
+  o->resizing = false;
+  o->resizeSerial = 0;
+  o->nextPendingResize = NULL;
+  o->sendResized = NULL;
+  o->constant = true;
+  o->borrowed = false;
+  o->version = 0;
   return 0;
 }
 
 void hTable_free(HvTable *o) {
-  hv_free(o->buffer);
+  if (!o->constant && !o->borrowed) hTable_freeBuffer(o->buffer);
+}
+
+float *hTable_newBuffer(const HvTable *o, hv_uint32_t newLength) {
+  const hv_uint32_t newAllocated = hTable_sizeForLength(newLength) + HV_N_SIMD;
+
+  // arena blocks are always aligned for SIMD access, which realloc is not
+  float *b = (float *) hv_arena_malloc(newAllocated * sizeof(float));
+  hv_assert(b != NULL); // error while allocating new buffer!
+  const hv_uint32_t numCopied = hv_min_ui(o->size, newAllocated);
+  hv_memcpy(b, o->buffer, numCopied * sizeof(float));
+  hv_memclear(b + numCopied, (newAllocated - numCopied) * sizeof(float)); // clear new parts of the buffer
+  return b;
+}
+
+float *hTable_swapBuffer(HvTable *o, float *buffer, hv_uint32_t newLength, bool borrowed) {
+  float *const oldBuffer = (o->constant || o->borrowed) ? NULL : o->buffer;
+  o->constant = false;
+  o->borrowed = borrowed;
+  o->version++;
+  o->buffer = buffer;
+  o->length = newLength;
+  o->size = hTable_sizeForLength(newLength);
+  o->allocated = o->size + HV_N_SIMD;
+  return oldBuffer;
+}
+
+void hTable_freeBuffer(float *buffer) {
+  hv_arena_free(buffer);
 }
 
 int hTable_resize(HvTable *o, hv_uint32_t newLength) {
   // TODO(mhroth): update context with memory allocated by table
   // NOTE(mhroth): mirrored bytes are not necessarily carried over
-  const hv_uint32_t newSize = (newLength + HV_N_SIMD_MASK) & ~HV_N_SIMD_MASK;
-  if (newSize == o->size) return 0; // early exit if no change in size
-  const hv_uint32_t oldSizeBytes = (hv_uint32_t) (o->size * sizeof(float));
-  const hv_uint32_t newAllocated = newSize + HV_N_SIMD;
-  const hv_uint32_t newAllocatedBytes = (hv_uint32_t) (newAllocated * sizeof(float));
-
-  float *b = (float *) hv_realloc(o->buffer, newAllocatedBytes);
-  hv_assert(b != NULL); // error while reallocing!
-  // ensure that hv_realloc has given us a correctly aligned buffer
-  if ((((hv_uintptr_t) (const void *) b) & ((0x1<<HV_N_SIMD)-1)) == 0) {
-    if (newSize > o->size) {
-      hv_memclear(b + o->size, (newAllocated - o->size) * sizeof(float)); // clear new parts of the buffer
-    }
-    o->buffer = b;
-  } else {
-    // if not, we have to re-malloc ourselves
-    char *c = (char *) hv_malloc(newAllocatedBytes);
-    hv_assert(c != NULL); // error while allocating new buffer!
-    if (newAllocatedBytes > oldSizeBytes) {
-      hv_memcpy(c, b, oldSizeBytes);
-      hv_memclear(c + oldSizeBytes, newAllocatedBytes - oldSizeBytes);
-    } else {
-      hv_memcpy(c, b, newAllocatedBytes);
-    }
-    hv_free(b);
-    o->buffer = (float *) c;
-  }
-  o->length = newLength;
-  o->size = newSize;
-  o->allocated = newAllocated;
-  return (int) (newAllocated - oldSizeBytes - (HV_N_SIMD*sizeof(float)));
+  if (hTable_sizeForLength(newLength) == o->size) return 0; // early exit if no change in size
+  const hv_uint32_t oldAllocated = o->allocated;
+  hTable_freeBuffer(hTable_swapBuffer(o, hTable_newBuffer(o, newLength), newLength, false));
+  return (int) ((o->allocated - oldAllocated) * sizeof(float));
 }
 
 void hTable_onMessage(HeavyContextInterface *_c, HvTable *o, int letIn, const HvMessage *m,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
-  if (msg_compareSymbol(m,0,"resize") && msg_isFloat(m,1) && msg_getFloat(m,1) >= 0.0f) {
-    hTable_resize(o, (int) hv_ceil_f(msg_getFloat(m,1))); // apply ceil to ensure that tables always have enough space
+  if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_resize) && msg_isFloat(m,1) && msg_getFloat(m,1) >= 0.0f) {
+    const hv_uint32_t newLength = (hv_uint32_t) hv_ceil_f(msg_getFloat(m,1)); // ensure that tables always have enough space
+
+    // if the context can resize it off the audio thread, the new buffer arrives at a later block,
+    // and the new size is only sent once the table has it
+    if (!hv_requestTableResize(_c, o, newLength)) hTable_resize(o, newLength);
+    else if (o->resizing) {
+      o->sendResized = sendMessage;
+      return;
+    }
 
     // send out the new size of the table
     HvMessage *n = HV_MESSAGE_ON_STACK(1);
-    msg_initWithFloat(n, msg_getTimestamp(m), (float) hTable_getSize(o));
+    msg_initWithFloat(n, msg_getTimestamp(m), (float) hTable_sizeForLength(newLength));
     sendMessage(_c, 0, n);
   }
 
-  else if (msg_compareSymbol(m,0,"mirror")) {
+  else if (msg_compareBuiltinSymbol(m, 0, HV_SYMBOL_mirror)) {
+    hv_assert(!o->constant); // constant tables may be read-only
     hv_memcpy(o->buffer+o->size, o->buffer, HV_N_SIMD*sizeof(float));
   }
 }
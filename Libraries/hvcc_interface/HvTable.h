@@ -39,18 +39,60 @@ typedef struct HvTable {
   hv_uint32_t allocated;
 
   hv_uint32_t head; // the most recently written point
+
+  bool constant; // the buffer is static data shared by all instances, it is never written to or freed
+  bool borrowed; // the buffer holds the samples of an HvMappedFile, which belong to the file
+  hv_uint32_t version; // changed whenever the table gets a new buffer or the host sets its length
+
+  // deferred resizing (see hv_setTableResizeQueueSize), only used on the audio thread
+  hv_uint32_t requestedLength; // the length to resize to once the current resize has finished
+  bool resizing; // true while a new buffer is being prepared on another thread, or waits for room in the queue
+  hv_uint32_t resizeSerial; // changed when the host resizes the table, such that the resizes in flight are dropped
+  struct HvTable *nextPendingResize; // the next table whose resize request waits for room in the queue
+  // sends the new size of the table once the new buffer is swapped in, or NULL
+  void (*sendResized)(HeavyContextInterface *, int, const HvMessage *);
 } HvTable;
 
 hv_size_t hTable_init(HvTable *o, int length);
 
 hv_size_t hTable_initWithData(HvTable *o, int length, const float *data);
 
+/** Takes ownership of the data, which must have been allocated with hv_arena_malloc(). */
 hv_size_t hTable_initWithFinalData(HvTable *o, int length, float *data);
 
+/**
+ * Uses constant data as the buffer of the table without copying it, so that every instance shares it.
+ * The data must hold hTable_sizeForLength(length) + HV_N_SIMD values and be aligned like hv_malloc()
+ * memory. It may be read-only, so nothing may write to the table. Resizing it moves it to the heap.
+ */
+hv_size_t hTable_initWithConstData(HvTable *o, int length, const float *data);
+
 void hTable_free(HvTable *o);
 
 int hTable_resize(HvTable *o, hv_uint32_t newLength);
 
+/** Returns the size of a table of the given length, rounded up to a whole number of SIMD vectors. */
+static inline hv_uint32_t hTable_sizeForLength(hv_uint32_t length) {
+  return (length + HV_N_SIMD_MASK) & ~HV_N_SIMD_MASK;
+}
+
+/**
+ * Allocates a buffer for the table at a new length and copies the current contents into it.
+ * Does not modify the table, so it can be called on another thread while the table is in use.
+ */
+float *hTable_newBuffer(const HvTable *o, hv_uint32_t newLength);
+
+/**
+ * Replaces the buffer of the table with one from hTable_newBuffer(), or with the samples of an
+ * HvMappedFile if borrowed is true.
+ * @return  The old buffer, which the caller must release with hTable_freeBuffer().
+ *          NULL if the table did not own the old buffer.
+ */
+float *hTable_swapBuffer(HvTable *o, float *buffer, hv_uint32_t newLength, bool borrowed);
+
+/** Frees a buffer from hTable_newBuffer() that a table no longer uses. Arena memory is left alone. */
+void hTable_freeBuffer(float *buffer);
+
 void hTable_onMessage(HeavyContextInterface *_c, HvTable *o, int letIn, const HvMessage *m,
     void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *));
 
@@ -52,3 +52,32 @@ hv_uint32_t hv_string_to_hash(const char *str) {
   x ^= (x >> 15);
   return x;
 }
+
+void hv_random_seed(hv_uint32_t *state, hv_uint32_t seed) {
+  // fill the state with the output of a 32-bit SplitMix (MurmurHash3 finaliser), which is never
+  // all zeros for four consecutive values
+  for (int i = 0; i < 4; ++i) {
+    seed += 0x9E3779B9;
+    hv_uint32_t z = seed;
+    z = (z ^ (z >> 16)) * 0x85EBCA6B;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35;
+    state[i] = z ^ (z >> 16);
+  }
+}
+
+void hv_random_jump(hv_uint32_t *state) {
+  static const hv_uint32_t JUMP[] = { 0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B };
+  hv_uint32_t s[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    for (int b = 0; b < 32; ++b) {
+      if (JUMP[i] & (1u << b)) {
+        s[0] ^= state[0];
+        s[1] ^= state[1];
+        s[2] ^= state[2];
+        s[3] ^= state[3];
+      }
+      hv_random_next(state);
+    }
+  }
+  state[0] = s[0]; state[1] = s[1]; state[2] = s[2]; state[3] = s[3];
+}
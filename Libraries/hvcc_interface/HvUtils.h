@@ -213,10 +213,55 @@ extern "C" {
 #endif
   // Returns a 32-bit hash of any string. Returns 0 if string is NULL.
   hv_uint32_t hv_string_to_hash(const char *str);
+
+  // Initialises the four words of xoshiro128+ state from any seed.
+  void hv_random_seed(hv_uint32_t *state, hv_uint32_t seed);
+
+  // Advances the xoshiro128+ state by 2^64 steps, giving a sequence that does not overlap with
+  // the original one.
+  void hv_random_jump(hv_uint32_t *state);
 #ifdef __cplusplus
 }
 #endif
 
+#if defined(__cplusplus) && (__cplusplus >= 201402L)
+// The same hash as hv_string_to_hash(), but it can be evaluated by the compiler, such that
+// getHashForString() can hash string literals in constant expressions.
+// Bytes are combined explicitly, which matches the word reads of the runtime version on little-endian targets.
+static constexpr hv_uint32_t __hv_utils_string_to_hash(const char *str) {
+  if (str == nullptr) return 0;
+
+  const hv_uint32_t n = 0x5bd1e995;
+  const hv_int32_t r = 24;
+
+  hv_uint32_t len = 0;
+  while (str[len] != '\0') ++len;
+  hv_uint32_t x = len; // seed (0) ^ len
+
+  while (len >= 4) {
+    hv_uint32_t k = (hv_uint32_t) (hv_uint8_t) str[0] | ((hv_uint32_t) (hv_uint8_t) str[1] << 8) |
+        ((hv_uint32_t) (hv_uint8_t) str[2] << 16) | ((hv_uint32_t) (hv_uint8_t) str[3] << 24);
+    k *= n;
+    k ^= (k >> r);
+    k *= n;
+    x *= n;
+    x ^= k;
+    str += 4; len -= 4;
+  }
+  // the tail bytes are sign extended, like the chars of the runtime version
+  switch (len) {
+    case 3: x ^= ((hv_uint32_t) (hv_int32_t) str[2]) * 0x10000u;
+    case 2: x ^= ((hv_uint32_t) (hv_int32_t) str[1]) * 0x100u;
+    case 1: x ^= (hv_uint32_t) (hv_int32_t) str[0]; x *= n;
+    default: break;
+  }
+  x ^= (x >> 13);
+  x *= n;
+  x ^= (x >> 15);
+  return x;
+}
+#endif
+
 // Math
 #include <math.h>
 static inline hv_size_t __hv_utils_max_ui(hv_size_t x, hv_size_t y) { return (x > y) ? x : y; }
@@ -272,6 +317,21 @@ static inline hv_int32_t __hv_utils_min_i(hv_int32_t x, hv_int32_t y) { return (
 #endif
 #define hv_min_max_log2(a) __hv_utils_min_max_log2(a)
 
+// Random
+// xoshiro128+ (http://prng.di.unimi.it). The upper bits of the result are the best.
+static inline hv_uint32_t __hv_utils_random_next(hv_uint32_t *s) {
+  const hv_uint32_t x = s[0] + s[3];
+  const hv_uint32_t t = s[1] << 9;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 11) | (s[3] >> 21);
+  return x;
+}
+#define hv_random_next(a) __hv_utils_random_next(a)
+
 // Atomics
 #if HV_WIN
   #include <windows.h>
@@ -298,7 +358,7 @@ static inline hv_int32_t __hv_utils_min_i(hv_int32_t x, hv_int32_t y) { return (
     #define hv_atomic_bool atomic_flag
     #define HV_SPINLOCK_ACQUIRE(_x) while (atomic_flag_test_and_set_explicit(&_x, memory_order_acquire))
     #define HV_SPINLOCK_TRY(_x) return !atomic_flag_test_and_set_explicit(&_x, memory_order_acquire)
-    #define HV_SPINLOCK_RELEASE(_x) atomic_flag_clear_explicit(memory_order_release)
+    #define HV_SPINLOCK_RELEASE(_x) atomic_flag_clear_explicit(&_x, memory_order_release)
   #endif
 #endif
 #ifndef hv_atomic_bool
@@ -314,4 +374,27 @@ static inline hv_int32_t __hv_utils_min_i(hv_int32_t x, hv_int32_t y) { return (
   #define HV_SPINLOCK_RELEASE(_x) (_x = false)
 #endif
 
+// Store fence, makes all preceding writes visible before any of the following ones
+#if __SSE__ || HV_SIMD_SSE
+#include <xmmintrin.h>
+#define hv_sfence() _mm_sfence()
+#elif __arm__ || HV_SIMD_NEON
+  #if __ARM_ACLE
+    #include <arm_acle.h>
+    // https://msdn.microsoft.com/en-us/library/hh875058.aspx#BarrierRestrictions
+    // http://doxygen.reactos.org/d8/d47/armintr_8h_a02be7ec76ca51842bc90d9b466b54752.html
+    #define hv_sfence() __dmb(0xE) /* _ARM_BARRIER_ST */
+  #elif defined(__GNUC__)
+    #define hv_sfence() __asm__ volatile ("dmb 0xE":::"memory")
+  #else
+    // http://stackoverflow.com/questions/19965076/gcc-memory-barrier-sync-synchronize-vs-asm-volatile-memory
+    #define hv_sfence() __sync_synchronize()
+  #endif
+#elif HV_WIN
+// https://msdn.microsoft.com/en-us/library/windows/desktop/ms684208(v=vs.85).aspx
+#define hv_sfence() _WriteBarrier()
+#else
+#define hv_sfence() __asm__ volatile("" : : : "memory")
+#endif
+
 #endif // _HEAVY_UTILS_H_
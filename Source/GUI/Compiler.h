@@ -1,6 +1,7 @@
 #pragma once
 #include "../JIT/jit.h"
 #include "../Utility/whereami.h"
+#include <regex>
 
 namespace hvcc
 {
@@ -17,7 +18,15 @@ extern "C" int error_handler(int level, const char *filename, int line, int colu
 
 struct Compiler : public Thread
 {
+    // Memory sizes passed to hv_<name>_new_with_options, estimated from the patch graph
+    struct MemoryOptions
+    {
+        int poolKb = 10;
+        int inQueueKb = 2;
+        int outQueueKb = 0;
+    };
     
+
     inline static String cxxPath = "";
     inline static String pyPath = "";
     inline static File workingDir = File();
@@ -70,6 +79,7 @@ struct Compiler : public Thread
     
     String currentPatch;
     String currentObjectID;
+    MemoryOptions memoryOptions;
     
     static void setPaths(String python, String cxx) {
         pyPath = python;
@@ -132,6 +142,9 @@ struct Compiler : public Thread
         message.writeString(currentObjectID);
         message.writeString("Load");
         message.writeString(libPath);
+        message.writeInt(memoryOptions.poolKb);
+        message.writeInt(memoryOptions.inQueueKb);
+        message.writeInt(memoryOptions.outQueueKb);
         dynamic_cast<ChildProcessWorker*>(JUCEApplicationBase::getInstance())->sendMessageToCoordinator(message.getMemoryBlock());
     }
     
@@ -169,11 +182,23 @@ struct Compiler : public Thread
         
         // Generate C++ code
         system(generationCommand.toRawUTF8());
+        makeConstantTables(File(inPath));
+        internSymbolLiterals(File(inPath));
+        makePerfectHashSwitches(File(inPath));
+        
+        // The patch links against the runtime inside the external, so it must use the same headers
+        auto runtimeHeaders = workingDir.getChildFile("hvcc_interface");
+        for(auto& header : runtimeHeaders.findChildFiles(File::findFiles, false, "*.h;*.hpp")) {
+            header.copyFileTo(tmpDir.getChildFile("c").getChildFile(header.getFileName()));
+        }
         
         // Compile and link the code
         system(compileCommand.toRawUTF8());
         system(linkCommand.toRawUTF8());
         
+        // Size the context from the intermediate representation before it gets deleted
+        memoryOptions = estimateMemoryOptions(tmpDir.getChildFile("ir"));
+        
         // Clean up
         File(outPath).deleteFile();
         File(tmpDir).getChildFile("c").deleteRecursively();
@@ -183,6 +208,238 @@ struct Compiler : public Thread
         return libPath;
     }
     
+    // Tables that nothing can write to are attached to their data in place instead of being copied
+    // into every instance, so the data is shared and only paged in when it is read.
+    // A table can be written to by tabwrite objects, by messages to the table itself ("resize", "mirror"),
+    // and by the host or a tabwrite that is "set" to it if the table can be looked up by its hash.
+    static void makeConstantTables(const File& source) {
+        auto code = source.loadFileAsString().toStdString();
+        
+        // Must match the runtime (HvTable.c), tables are padded by one SIMD vector of up to 8 floats
+        const int maxSimdWidth = 8;
+        
+        auto lookupStart = code.find("::getTableForHash(");
+        if(lookupStart == std::string::npos) return;
+        auto lookup = code.substr(lookupStart, code.find("\n}", lookupStart) - lookupStart);
+        
+        std::vector<std::smatch> inits;
+        std::regex initPattern(R"(hTable_initWithData\(&(hTable_\w+), \d+, (\w+)\))");
+        for(auto it = std::sregex_iterator(code.begin(), code.end(), initPattern); it != std::sregex_iterator(); ++it) {
+            inits.push_back(*it);
+        }
+        
+        std::string result = code;
+        for(auto& init : inits) {
+            auto table = init[1].str();
+            auto data = init[2].str();
+            
+            std::regex writer("(Tabwrite_init\\([^;]*&" + table + "\\b)|(hTable_onMessage\\([^;]*" + table + "\\b)");
+            if(std::regex_search(code, writer) || std::regex_search(lookup, std::regex("\\b" + table + "\\b"))) continue;
+            
+            std::smatch definition;
+            std::regex definitionPattern("(static )?float " + data + "\\[(\\d+)\\] = \\{");
+            if(!std::regex_search(result, definition, definitionPattern)) continue;
+            
+            // The rest of the padded array is zero-initialised
+            int padded = ((std::stoi(definition[2].str()) + maxSimdWidth - 1) / maxSimdWidth + 1) * maxSimdWidth;
+            result.replace(definition.position(0), definition.length(0),
+                           "alignas(32) static const float " + data + "[" + std::to_string(padded) + "] = {");
+            result = std::regex_replace(result, std::regex("hTable_initWithData\\(&" + table + ","),
+                                        "hTable_initWithConstData(&" + table + ",");
+        }
+        
+        if(result != code) source.replaceWithText(String(result));
+    }
+    
+    // Symbols are compared and set by their interned id while processing, but the generated code passes
+    // string literals, which are hashed and looked up on every call, and interned on the audio thread the
+    // first time. Every literal is interned once instead, when the patch library is loaded.
+    static void internSymbolLiterals(const File& source) {
+        auto code = source.loadFileAsString().toStdString();
+        
+        std::regex callPattern(R"(msg_(setSymbol|compareSymbol)\((\w+), (\w+), ("(?:[^"\\]|\\.)*")\))");
+        std::vector<std::string> literals;
+        std::string result;
+        auto last = code.cbegin();
+        for(auto it = std::sregex_iterator(code.begin(), code.end(), callPattern); it != std::sregex_iterator(); ++it) {
+            auto& call = *it;
+            auto literal = call[4].str();
+            auto index = std::distance(literals.begin(), std::find(literals.begin(), literals.end(), literal));
+            if(index == (long)literals.size()) literals.push_back(literal);
+            
+            result.append(last, call[0].first);
+            result += "msg_" + call[1].str() + "Id(" + call[2].str() + ", " + call[3].str() + ", hv_patchSymbols[" + std::to_string(index) + "])";
+            last = call[0].second;
+        }
+        if(literals.empty()) return;
+        result.append(last, code.cend());
+        
+        // The ids go after the includes, which declare the symbol table
+        std::string table = "\nstatic const hv_uint32_t hv_patchSymbols[] = {\n";
+        for(auto& literal : literals) table += "  hSymbol_internLiteral(" + literal + "),\n";
+        table += "};\n";
+        
+        std::regex includePattern("#include [^\n]*\n");
+        std::string::size_type position = 0;
+        for(auto it = std::sregex_iterator(result.begin(), result.end(), includePattern); it != std::sregex_iterator(); ++it) {
+            position = it->position(0) + it->length(0);
+        }
+        result.insert(position, table);
+        
+        source.replaceWithText(String(result));
+    }
+    
+    // The generated receiver and table lookups switch on 32-bit hashes, which compile to a search
+    // through the cases. They switch on the index of the hash in a perfect hash of the cases instead,
+    // which compiles to a jump table. The perfect hash is built when the patch library is loaded.
+    static void makePerfectHashSwitches(const File& source) {
+        auto code = source.loadFileAsString().toStdString();
+        auto result = makePerfectHashSwitch(code, "::scheduleMessageForReceiver(", "hv_receiverMap");
+        result = makePerfectHashSwitch(result, "::getTableForHash(", "hv_tableMap");
+        if(result != code) source.replaceWithText(String(result));
+    }
+    
+    static std::string makePerfectHashSwitch(const std::string& code, const std::string& function, const std::string& map) {
+        // With fewer cases, the search is as fast as the perfect hash
+        const size_t minCases = 8;
+        
+        auto start = code.find(function);
+        if(start == std::string::npos) return code;
+        auto end = code.find("\n}", start);
+        auto body = code.substr(start, end - start);
+        
+        std::smatch switchStatement;
+        if(!std::regex_search(body, switchStatement, std::regex(R"(switch \((\w+)\) \{)"))) return code;
+        auto key = switchStatement[1].str();
+        
+        std::regex casePattern(R"(case (0x[0-9A-Fa-f]+):)");
+        std::vector<std::string> hashes;
+        std::string result;
+        auto last = body.cbegin();
+        for(auto it = std::sregex_iterator(body.begin(), body.end(), casePattern); it != std::sregex_iterator(); ++it) {
+            result.append(last, (*it)[0].first);
+            result += "case " + std::to_string(hashes.size()) + ":";
+            hashes.push_back((*it)[1].str());
+            last = (*it)[0].second;
+        }
+        if(hashes.size() < minCases) return code;
+        result.append(last, body.cend());
+        result = std::regex_replace(result, std::regex("switch \\(" + key + "\\) \\{"),
+                                    "switch (hPh_find(&" + map + ".hash, " + key + ")) {",
+                                    std::regex_constants::format_first_only);
+        
+        // The map goes before the function, whose cases are now the indices in the array of hashes
+        std::string definition = "static const hv_uint32_t " + map + "Hashes[] = {\n";
+        for(auto& hash : hashes) definition += "  " + hash + ",\n";
+        definition += "};\n\n";
+        definition += "static struct " + map + "_t {\n";
+        definition += "  HvPerfectHash hash;\n";
+        definition += "  " + map + "_t() { hPh_init(&hash, " + map + "Hashes, " + std::to_string(hashes.size()) + "); }\n";
+        definition += "  ~" + map + "_t() { hPh_free(&hash); }\n";
+        definition += "} " + map + ";\n\n";
+        
+        auto lineStart = code.rfind('\n', start);
+        lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+        return code.substr(0, lineStart) + definition + code.substr(lineStart, start - lineStart) + result + code.substr(end);
+    }
+    
+    // Estimates the worst-case message pool and queue sizes of a patch from the heavy IR.
+    // Every pending message occupies one pool chunk, so we count how many messages can be
+    // scheduled at once (delays, remote sends, receivers) and how large the biggest one can get.
+    static MemoryOptions estimateMemoryOptions(const File& irDir) {
+        MemoryOptions options;
+        
+        auto irFiles = irDir.findChildFiles(File::findFiles, false, "*.heavy.ir.json");
+        if(irFiles.isEmpty()) return options;
+        
+        auto ir = JSON::parse(irFiles.getFirst());
+        auto* objects = ir["objects"].getDynamicObject();
+        if(!objects) return options;
+        
+        // Must match the runtime (HvMessage.h, HvMessagePool.c)
+        const int messageHeaderSize = 8;
+        const int elementSize = 8;
+        const int delayTypicalMessages = 8; // delays have no limit, this is only an estimate
+        const int poolBlockSize = 512;
+        const int poolNumChunkSizes = 5;
+        const int queueMessageSize = 32;
+        const int queueMessagesPerReceiver = 16;
+        
+        int maxElements = 1;
+        int pendingMessages = 0;
+        int externSends = 0;
+        
+        // extern is either a bool or the parameter kind ("param", "event"), depending on the object
+        auto isExtern = [](const var& value) {
+            return value.isBool() ? static_cast<bool>(value) : value.toString().isNotEmpty();
+        };
+        
+        for(auto& object : objects->getProperties()) {
+            auto type = object.value["type"].toString();
+            auto args = object.value["args"];
+            
+            if(type == "__delay") {
+                pendingMessages += delayTypicalMessages;
+            }
+            else if(type == "__pack") {
+                maxElements = std::max(maxElements, args["values"].size());
+            }
+            else if(type == "__send") {
+                pendingMessages++;
+                if(isExtern(args["extern"])) externSends++;
+            }
+            else if(type == "__message") {
+                // symbols are interned, so only the number of elements counts
+                auto countMessage = [&](const var& message) {
+                    maxElements = std::max(maxElements, message.size());
+                };
+                
+                if(auto* locals = args["local"].getArray()) {
+                    for(auto& local : *locals) {
+                        if(local.isArray()) countMessage(local);
+                    }
+                }
+                if(auto* remotes = args["remote"].getArray()) {
+                    for(auto& remote : *remotes) {
+                        if(remote["message"].isArray()) countMessage(remote["message"]);
+                        pendingMessages++;
+                    }
+                }
+            }
+        }
+        
+        int externReceivers = 0;
+        if(auto* receivers = ir["control"]["receivers"].getDynamicObject()) {
+            for(auto& receiver : receivers->getProperties()) {
+                // each receiver dispatch is scheduled through the message queue
+                pendingMessages++;
+                if(isExtern(receiver.value["extern"])) externReceivers++;
+            }
+        }
+        
+        // pool chunks are powers of two, the smallest one is 16 bytes
+        int messageSize = messageHeaderSize + maxElements * elementSize;
+        int chunkSize = std::max(16, (int)nextPowerOfTwo(messageSize));
+        
+        int inQueueBytes = externReceivers * queueMessagesPerReceiver * queueMessageSize;
+        options.inQueueKb = jlimit(1, 64, (inQueueBytes + 1023) / 1024);
+        
+        // reserve one block per chunk size class and double the estimate for headroom.
+        // process() moves the whole input queue into the pool at once, so a full queue must fit as well.
+        int inQueueMessages = options.inQueueKb * 1024 / queueMessageSize;
+        int poolBytes = 2 * (pendingMessages * chunkSize) + poolNumChunkSizes * poolBlockSize
+                      + inQueueMessages * chunkSize;
+        
+        // never go below the default of the runtime
+        options.poolKb = jlimit(MemoryOptions().poolKb, 1024, (poolBytes + 1023) / 1024);
+        
+        // sends are only queued for the host when something listens to them
+        int outQueueBytes = externSends * queueMessagesPerReceiver * queueMessageSize;
+        options.outQueueKb = externSends ? jlimit(1, 64, (outQueueBytes + 1023) / 1024) : 0;
+        
+        return options;
+    }
+    
     void compile(const String& patchContent, const String& ID) {
         if(isThreadRunning()) {
             std::cout << "Compile action already running!" << std::endl;
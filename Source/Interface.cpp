@@ -72,7 +72,11 @@ struct Interface : public ChildProcessCoordinator
             
             if(selector == "Load") {
                 auto path = stream.readString();
-                loadLibrary(invExternalsMap[ID], path);
+                Compiler::MemoryOptions options;
+                options.poolKb = stream.readInt();
+                options.inQueueKb = stream.readInt();
+                options.outQueueKb = stream.readInt();
+                loadLibrary(invExternalsMap[ID], path, options);
             }
             if(selector == "SaveState") {
                 auto content = stream.readString();
@@ -124,10 +128,10 @@ struct Interface : public ChildProcessCoordinator
         auto patchContent = String((char*)ostream.getData(), ostream.getDataSize());
         
         auto libdir = compiler.generateLibrary(patchContent);
-        loadLibrary(external, libdir);
+        loadLibrary(external, libdir, compiler.memoryOptions);
     }
     
-    void loadLibrary(void* external, const String& path) {
+    void loadLibrary(void* external, const String& path, const Compiler::MemoryOptions& options) {
         auto name = File(path).getFileNameWithoutExtension();
         
         loadedLibraries[ID] = std::make_unique<DynamicLibrary>();
@@ -135,10 +139,10 @@ struct Interface : public ChildProcessCoordinator
         lib->open(path);
         
         
-        auto* func = lib->getFunction("hv_" + name + "_new");
+        auto* func = lib->getFunction("hv_" + name + "_new_with_options");
         if(func) {
             
-            hvcc_load(external, (t_create)func);
+            hvcc_load(external, (t_create)func, options.poolKb, options.inQueueKb, options.outQueueKb);
             
             auto tmpdir = File(path).getParentDirectory().getParentDirectory();
             if(tmpdir.getFileName() == "tmp") {
@@ -5,7 +5,7 @@
 extern "C" {
 #endif
 
-typedef HeavyContextInterface* (*t_create)(double);
+typedef HeavyContextInterface* (*t_create)(double sampleRate, int poolKb, int inQueueKb, int outQueueKb);
 
 void init_interface();
 // Interface from pd to worker
@@ -20,7 +20,7 @@ void hvcc_save_state(void* x, const char* content);
 
 void load_state(void* obj, const char* content);
 
-void hvcc_load(void* x, t_create createFunc);
+void hvcc_load(void* x, t_create createFunc, int poolKb, int inQueueKb, int outQueueKb);
 
 #if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
 }
@@ -3,6 +3,13 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #if defined(HAVE_LIBDL) || defined(__FreeBSD__)
 #include <dlfcn.h>
@@ -13,6 +20,8 @@
 #endif
 
 #include "Interface.h"
+#include "HvArena.h"
+#include "HvPerfectHash.h"
 
 t_widgetbehavior hvcc_widgetbehaviour;
 
@@ -38,7 +47,42 @@ const char* hvcc_path = "/opt/homebrew/bin/hvcc";
 const char* hvcc_path = HVCC_PATH;
 #endif
 
+// Print messages are queued on the audio thread and posted from the scheduler
+#define HVCC_PRINT_QUEUE_KB 8
+#define HVCC_MAX_PRINTS_PER_TICK 64
+
+// Table resizes are requested by the audio thread and allocated on a worker thread,
+// which looks for requests every few milliseconds
+#define HVCC_RESIZE_QUEUE_KB 1
+#define HVCC_RESIZE_POLL_MS 2
+
+// Bound tables are copied into their Pd arrays a slice at a time, this many samples per tick over all tables
+#define HVCC_MAX_TABLE_SAMPLES_PER_TICK 8192
+
+// Longest message that is forwarded between heavy and Pd
+#define HVCC_MAX_ATOMS 64
+
 static t_class *hvcc_class;
+static t_class *hvcc_inlet_class;
+
+struct _hvcc;
+
+// A heavy table that is shown in a Pd array
+typedef struct _hvcc_table
+{
+    t_symbol* x_table;
+    hv_uint32_t x_hash;
+    t_symbol* x_array;
+    int x_cursor; // where the next copy continues
+} t_hvcc_table;
+
+// Proxy that forwards everything sent to a control inlet to its heavy receiver
+typedef struct _hvcc_inlet
+{
+    t_pd x_pd;
+    struct _hvcc* x_owner;
+    int x_index;
+} t_hvcc_inlet;
 
 typedef struct _hvcc
 {
@@ -48,8 +92,27 @@ typedef struct _hvcc
     int x_n_out;
     t_inlet* x_inlets[8];
     t_outlet* x_outlets[8];
+    int x_n_control_in;
+    t_inlet** x_control_inlets;
+    t_hvcc_inlet* x_control_proxies;
+    t_symbol** x_control_in_names;
+    hv_uint32_t* x_control_in_hashes;
+    int x_n_control_out;
+    t_outlet** x_control_outlets;
+    t_symbol** x_control_out_names;
+    hv_uint32_t* x_control_out_hashes;
+    HvPerfectHash x_control_out_map;
+    t_clock* x_send_clock;
+    double x_dsp_time;
+    double x_block_ms;
+    int x_n_tables;
+    int x_next_table; // the table that the next copy starts with
+    t_hvcc_table* x_tables;
     t_glist* x_glist;
     t_clock* x_clock;
+    pthread_t x_resize_thread;
+    pthread_mutex_t x_resize_lock; // held by the worker while it uses x_hv_object
+    volatile int x_resize_running;
     char* x_state;
     t_float x_sig;
     
@@ -62,6 +125,275 @@ static void printHook(void* c, const char* receiverName, const char* msgString,
     
 }
 
+// Forwards a message sent by heavy to its control outlet and to Pd receivers with the same name
+static void hvcc_sent_message(void* obj, hv_uint32_t sendHash, const HvMessage* m)
+{
+    t_hvcc* x = (t_hvcc*)obj;
+    
+    int i = hPh_find(&x->x_control_out_map, sendHash);
+    if(i < 0) return;
+    
+    t_outlet* outlet = x->x_control_outlets[i];
+    t_pd* receiver = x->x_control_out_names[i]->s_thing;
+    
+    int argc = hv_min_i((int)hv_msg_getNumElements(m), HVCC_MAX_ATOMS);
+    t_atom argv[HVCC_MAX_ATOMS];
+    
+    for(int j = 0; j < argc; j++) {
+        if(hv_msg_isFloat(m, j)) SETFLOAT(argv + j, hv_msg_getFloat(m, j));
+        else if(hv_msg_isSymbol(m, j)) SETSYMBOL(argv + j, gensym(hv_msg_getSymbol(m, j)));
+        else if(hv_msg_isHash(m, j)) SETFLOAT(argv + j, (t_float)hv_msg_getHash(m, j));
+        else SETSYMBOL(argv + j, &s_bang);
+    }
+    
+    if(argc == 1 && hv_msg_isBang(m, 0)) {
+        if(receiver) pd_bang(receiver);
+        outlet_bang(outlet);
+    }
+    else if(argc == 1 && hv_msg_isFloat(m, 0)) {
+        if(receiver) pd_float(receiver, argv[0].a_w.w_float);
+        outlet_float(outlet, argv[0].a_w.w_float);
+    }
+    else if(argv[0].a_type == A_SYMBOL) {
+        if(receiver) typedmess(receiver, argv[0].a_w.w_symbol, argc - 1, argv + 1);
+        outlet_anything(outlet, argv[0].a_w.w_symbol, argc - 1, argv + 1);
+    }
+    else {
+        if(receiver) pd_list(receiver, &s_list, argc, argv);
+        outlet_list(outlet, &s_list, argc, argv);
+    }
+}
+
+// Drains everything heavy sent during the last DSP ticks in one pass
+static void hvcc_send_tick(t_hvcc* x)
+{
+    if(x->x_hv_object) hv_processSentMessages(x->x_hv_object, hvcc_sent_message, x);
+}
+
+// Frees the control outlets, disconnecting them
+static void hvcc_free_control_outlets(t_hvcc* x)
+{
+    for(int i = 0; i < x->x_n_control_out; i++) {
+        canvas_deletelinesforio(x->x_glist, &x->x_obj,
+                                0, x->x_control_outlets[i]);
+        outlet_free(x->x_control_outlets[i]);
+    }
+    
+    freebytes(x->x_control_outlets, x->x_n_control_out * sizeof(t_outlet*));
+    x->x_control_outlets = NULL;
+}
+
+// Frees the control inlets, disconnecting them
+static void hvcc_free_control_inlets(t_hvcc* x)
+{
+    for(int i = 0; i < x->x_n_control_in; i++) {
+        canvas_deletelinesforio(x->x_glist, &x->x_obj,
+                                x->x_control_inlets[i], 0);
+        inlet_free(x->x_control_inlets[i]);
+    }
+    
+    freebytes(x->x_control_inlets, x->x_n_control_in * sizeof(t_inlet*));
+    freebytes(x->x_control_proxies, x->x_n_control_in * sizeof(t_hvcc_inlet));
+    x->x_control_inlets = NULL;
+    x->x_control_proxies = NULL;
+}
+
+// Looks up the names and hashes of the incoming or outgoing parameters and events of the patch,
+// so that we never need to hash a name on the message path
+static int hvcc_get_controls(HeavyContextInterface* context, int outgoing, t_symbol** names, hv_uint32_t* hashes)
+{
+    int n = 0;
+    int num_params = hv_getParameterInfo(context, 0, NULL);
+    for(int i = 0; i < num_params; i++) {
+        HvParameterInfo info;
+        hv_getParameterInfo(context, i, &info);
+        
+        int is_outgoing = info.type == HV_PARAM_TYPE_PARAMETER_OUT || info.type == HV_PARAM_TYPE_EVENT_OUT;
+        if(is_outgoing != outgoing) continue;
+        
+        if(names) names[n] = gensym(info.name);
+        if(hashes) hashes[n] = info.hash;
+        n++;
+    }
+    return n;
+}
+
+// Pd delivers messages in between DSP ticks, at a logical time that lies within the next block.
+// Returns how far into that block the current message belongs, so heavy can apply it on the right sample.
+// Heavy already splits the block at message timestamps, once per SIMD vector (a single sample in scalar
+// builds), so calling hv_process on shorter spans could not apply messages any earlier.
+static double hvcc_get_delay(t_hvcc* x)
+{
+    double delay = clock_gettimesince(x->x_dsp_time);
+    return (delay >= 0.0 && delay < x->x_block_ms) ? delay : 0.0;
+}
+
+// Sends a Pd message to a heavy receiver through its input queue
+static void hvcc_send_to_receiver(t_hvcc* x, hv_uint32_t hash, t_symbol* s, int argc, t_atom* argv)
+{
+    if(!x->x_hv_object) return;
+    
+    // float, symbol and list selectors are implied by the elements
+    int has_selector = s && s != &s_float && s != &s_symbol && s != &s_list && s != &s_bang;
+    int num_elements = hv_min_i(argc + has_selector, HVCC_MAX_ATOMS);
+    
+    HvMessage* m = (HvMessage*)hv_alloca(hv_msg_getByteSize(hv_max_i(num_elements, 1)));
+    hv_msg_init(m, hv_max_i(num_elements, 1), 0);
+    
+    int interned = 1;
+    if(num_elements == 0) hv_msg_setBang(m, 0);
+    if(has_selector) interned &= hv_msg_setSymbol(m, 0, s->s_name);
+    
+    for(int i = has_selector; i < num_elements; i++) {
+        t_atom* a = argv + i - has_selector;
+        if(a->a_type == A_FLOAT) hv_msg_setFloat(m, i, a->a_w.w_float);
+        else if(a->a_type == A_SYMBOL) interned &= hv_msg_setSymbol(m, i, a->a_w.w_symbol->s_name);
+        else hv_msg_setBang(m, i);
+    }
+    
+    if(!interned) {
+        pd_error(x, "[hvcc~]: symbol table is full, message dropped");
+    }
+    else if(!hv_sendMessageToReceiver(x->x_hv_object, hash, hvcc_get_delay(x), m)) {
+        pd_error(x, "[hvcc~]: input queue is full, message dropped");
+    }
+}
+
+static void hvcc_inlet_anything(t_hvcc_inlet* p, t_symbol* s, int argc, t_atom* argv)
+{
+    t_hvcc* x = p->x_owner;
+    hvcc_send_to_receiver(x, x->x_control_in_hashes[p->x_index], s, argc, argv);
+}
+
+// param <name> <value...>: sends to any incoming parameter or event of the patch
+static void hvcc_param(t_hvcc* x, t_symbol* s, int argc, t_atom* argv)
+{
+    if(argc < 1 || argv[0].a_type != A_SYMBOL) {
+        pd_error(x, "[hvcc~]: usage: param <name> <value>");
+        return;
+    }
+    
+    // symbols are unique, so comparing pointers is enough
+    t_symbol* name = argv[0].a_w.w_symbol;
+    for(int i = 0; i < x->x_n_control_in; i++) {
+        if(x->x_control_in_names[i] != name) continue;
+        
+        hvcc_send_to_receiver(x, x->x_control_in_hashes[i], &s_list, argc - 1, argv + 1);
+        return;
+    }
+    
+    pd_error(x, "[hvcc~]: no parameter named %s", name->s_name);
+}
+
+// table <name> <array>: shows a heavy table in a Pd array, which follows the table at display rate.
+// Pd arrays hold t_words rather than floats, so they can't share memory with heavy and the table is copied.
+// table <name>: stops updating the array
+static void hvcc_table(t_hvcc* x, t_symbol* table, t_symbol* array)
+{
+    for(int i = 0; i < x->x_n_tables; i++) {
+        if(x->x_tables[i].x_table != table) continue;
+        
+        if(array != &s_) {
+            x->x_tables[i].x_array = array;
+            return;
+        }
+        x->x_tables[i] = x->x_tables[x->x_n_tables - 1];
+        x->x_tables = (t_hvcc_table*)resizebytes(x->x_tables, x->x_n_tables * sizeof(t_hvcc_table), (x->x_n_tables - 1) * sizeof(t_hvcc_table));
+        x->x_n_tables--;
+        return;
+    }
+    if(array == &s_) return;
+    
+    x->x_tables = (t_hvcc_table*)resizebytes(x->x_tables, x->x_n_tables * sizeof(t_hvcc_table), (x->x_n_tables + 1) * sizeof(t_hvcc_table));
+    x->x_tables[x->x_n_tables].x_table = table;
+    x->x_tables[x->x_n_tables].x_hash = hv_stringToHash(table->s_name);
+    x->x_tables[x->x_n_tables].x_array = array;
+    x->x_tables[x->x_n_tables].x_cursor = 0;
+    x->x_n_tables++;
+}
+
+// load <name> <array>: copies a Pd array into a heavy table, resizing the table to fit
+static void hvcc_table_load(t_hvcc* x, t_symbol* table, t_symbol* array)
+{
+    if(!x->x_hv_object) return;
+    
+    int n;
+    t_word* vec;
+    t_garray* a = (t_garray*)pd_findbyclass(array, garray_class);
+    if(!a || !garray_getfloatwords(a, &n, &vec)) {
+        pd_error(x, "[hvcc~]: %s: no such array", array->s_name);
+        return;
+    }
+    
+    // DSP runs on this thread too, so the table can be resized right away. The resize worker
+    // may be copying the old buffer of this table, so it is held off while the buffer is replaced,
+    // and the resize it was working on is dropped.
+    hv_uint32_t hash = hv_stringToHash(table->s_name);
+    pthread_mutex_lock(&x->x_resize_lock);
+    int found = hv_table_setLength(x->x_hv_object, hash, n);
+    if(found) {
+        float* buffer = hv_table_getBuffer(x->x_hv_object, hash);
+        for(int i = 0; i < n; i++) buffer[i] = vec[i].w_float;
+    }
+    pthread_mutex_unlock(&x->x_resize_lock);
+    
+    if(!found) {
+        pd_error(x, "[hvcc~]: no table named %s", table->s_name);
+    }
+}
+
+// Copies the bound heavy tables into their Pd arrays, only redrawing the arrays that changed.
+// Large tables would take too long to copy on the audio thread at once, so each tick continues
+// where the last one stopped, and copies at most HVCC_MAX_TABLE_SAMPLES_PER_TICK samples.
+static void hvcc_update_tables(t_hvcc* x)
+{
+    int budget = HVCC_MAX_TABLE_SAMPLES_PER_TICK;
+    for(int k = 0; k < x->x_n_tables && budget > 0; k++) {
+        if(x->x_next_table >= x->x_n_tables) x->x_next_table = 0;
+        t_hvcc_table* t = x->x_tables + x->x_next_table;
+        float* buffer = hv_table_getBuffer(x->x_hv_object, t->x_hash);
+        t_garray* a = (t_garray*)pd_findbyclass(t->x_array, garray_class);
+        
+        int n;
+        t_word* vec;
+        if(!buffer || !a || !garray_getfloatwords(a, &n, &vec)) {
+            x->x_next_table++;
+            continue;
+        }
+        
+        int length = (int)hv_table_getLength(x->x_hv_object, t->x_hash);
+        int changed = n != length;
+        if(changed) {
+            garray_resize_long(a, length);
+            t->x_cursor = 0;
+            if(!garray_getfloatwords(a, &n, &vec)) {
+                x->x_next_table++;
+                continue;
+            }
+        }
+        
+        if(n > length) n = length;
+        if(t->x_cursor >= n) t->x_cursor = 0;
+        int end = (n - t->x_cursor > budget) ? t->x_cursor + budget : n;
+        for(int j = t->x_cursor; j < end; j++) {
+            changed |= vec[j].w_float != buffer[j];
+            vec[j].w_float = buffer[j];
+        }
+        budget -= end - t->x_cursor;
+        
+        if(changed) garray_redraw(a);
+        
+        // Move on to the next table once this one has been copied completely
+        if(end < n) {
+            t->x_cursor = end;
+        }
+        else {
+            t->x_cursor = 0;
+            x->x_next_table++;
+        }
+    }
+}
+
 void hvcc_save(t_gobj *z, t_binbuf *b)
 {
     t_hvcc* x = (t_hvcc *)z;
@@ -121,11 +453,38 @@ static void hvcc_focus(t_hvcc* x, t_floatarg* f)
 {
 }
 
-void hvcc_load(void* obj, t_create create)
+static HeavyContextInterface* hvcc_create(t_hvcc* x, t_create create, int poolKb, int inQueueKb, int outQueueKb)
+{
+    HeavyContextInterface* context = create(sys_getsr(), poolKb, inQueueKb, outQueueKb);
+    hv_setPrintMessageQueueSize(context, HVCC_PRINT_QUEUE_KB);
+    hv_setTableResizeQueueSize(context, (x->x_resize_running) ? HVCC_RESIZE_QUEUE_KB : 0);
+    return context;
+}
+
+void hvcc_load(void* obj, t_create create, int poolKb, int inQueueKb, int outQueueKb)
 {
     t_hvcc* x = (t_hvcc*)obj;
-    // Create the patch instance
-    x->x_hv_object = create(sys_getsr());
+    // The queues dominate the footprint of a patch, and the previous instance measured the rest of it.
+    // If the patch needs more, the arena grows while it is constructed.
+    size_t footprint = (size_t)(poolKb + inQueueKb + outQueueKb + HVCC_PRINT_QUEUE_KB + 2 * HVCC_RESIZE_QUEUE_KB) * 1024;
+    if(x->x_hv_object && (size_t)hv_getSize(x->x_hv_object) > footprint) {
+        footprint = (size_t)hv_getSize(x->x_hv_object);
+    }
+    
+    // Create the patch instance, with all of its memory carved from a locked arena
+    hArena_setActive(hArena_new(footprint, HV_ARENA_LOCKED));
+    HeavyContextInterface* context = hvcc_create(x, create, poolKb, inQueueKb, outQueueKb);
+    hArena_setActive(NULL);
+    
+    // The resize worker must not be inside the old instance while it is replaced, and neither must DSP
+    // while it is deleted. Deleting it releases its arena.
+    int dspstate = canvas_suspend_dsp();
+    pthread_mutex_lock(&x->x_resize_lock);
+    HeavyContextInterface* old_context = x->x_hv_object;
+    x->x_hv_object = context;
+    pthread_mutex_unlock(&x->x_resize_lock);
+    if(old_context) hv_delete(old_context);
+    canvas_resume_dsp(dspstate);
     
     int old_n_in = x->x_n_in;
     int old_n_out = x->x_n_out;
@@ -134,8 +493,39 @@ void hvcc_load(void* obj, t_create create)
     x->x_n_in = hv_getNumInputChannels(x->x_hv_object);
     x->x_n_out = hv_getNumOutputChannels(x->x_hv_object);
     
+    int n_control_in = hvcc_get_controls(x->x_hv_object, 0, NULL, NULL);
+    int n_control_out = hvcc_get_controls(x->x_hv_object, 1, NULL, NULL);
+    
+    // Control inlets/outlets come after the signal ones, so they only survive if nothing moves
+    int rebuild_control_inlets = x->x_n_in != old_n_in || n_control_in != x->x_n_control_in;
+    int rebuild_control_outlets = x->x_n_out != old_n_out || n_control_out != x->x_n_control_out;
+    
     gobj_vis(&x->x_obj.te_g, x->x_glist, 0);
     
+    if(rebuild_control_inlets) {
+        hvcc_free_control_inlets(x);
+    }
+    
+    if(rebuild_control_outlets) {
+        hvcc_free_control_outlets(x);
+    }
+    
+    freebytes(x->x_control_in_names, x->x_n_control_in * sizeof(t_symbol*));
+    freebytes(x->x_control_in_hashes, x->x_n_control_in * sizeof(hv_uint32_t));
+    x->x_control_in_names = (t_symbol**)getbytes(n_control_in * sizeof(t_symbol*));
+    x->x_control_in_hashes = (hv_uint32_t*)getbytes(n_control_in * sizeof(hv_uint32_t));
+    hvcc_get_controls(x->x_hv_object, 0, x->x_control_in_names, x->x_control_in_hashes);
+    
+    freebytes(x->x_control_out_names, x->x_n_control_out * sizeof(t_symbol*));
+    freebytes(x->x_control_out_hashes, x->x_n_control_out * sizeof(hv_uint32_t));
+    x->x_control_out_names = (t_symbol**)getbytes(n_control_out * sizeof(t_symbol*));
+    x->x_control_out_hashes = (hv_uint32_t*)getbytes(n_control_out * sizeof(hv_uint32_t));
+    hvcc_get_controls(x->x_hv_object, 1, x->x_control_out_names, x->x_control_out_hashes);
+    
+    // Sent messages are dispatched to their outlet with a collision-free lookup of the send hash
+    hPh_free(&x->x_control_out_map);
+    hPh_init(&x->x_control_out_map, x->x_control_out_hashes, n_control_out);
+    
     for(int i = (x->x_n_in - 1); i < (old_n_in - 1); i++) {
         if(i < 0) continue;
         canvas_deletelinesforio(x->x_glist, &x->x_obj,
@@ -160,6 +550,26 @@ void hvcc_load(void* obj, t_create create)
         x->x_outlets[i] = outlet_new(&x->x_obj, &s_signal);
     }
     
+    if(rebuild_control_inlets) {
+        x->x_control_inlets = (t_inlet**)getbytes(n_control_in * sizeof(t_inlet*));
+        x->x_control_proxies = (t_hvcc_inlet*)getbytes(n_control_in * sizeof(t_hvcc_inlet));
+        for(int i = 0; i < n_control_in; i++) {
+            x->x_control_proxies[i].x_pd = hvcc_inlet_class;
+            x->x_control_proxies[i].x_owner = x;
+            x->x_control_proxies[i].x_index = i;
+            x->x_control_inlets[i] = inlet_new(&x->x_obj, &x->x_control_proxies[i].x_pd, 0, 0);
+        }
+    }
+    x->x_n_control_in = n_control_in;
+    
+    if(rebuild_control_outlets) {
+        x->x_control_outlets = (t_outlet**)getbytes(n_control_out * sizeof(t_outlet*));
+        for(int i = 0; i < n_control_out; i++) {
+            x->x_control_outlets[i] = outlet_new(&x->x_obj, 0);
+        }
+    }
+    x->x_n_control_out = n_control_out;
+    
     // Update DSP
     canvas_update_dsp();
     
@@ -207,9 +617,43 @@ static t_int* hvcc_vis(t_gobj *z, t_glist *glist, int vis) {
 static t_int* hvcc_tick(t_hvcc* x) {
     
     dequeue_messages();
+    
+    if(x->x_hv_object) {
+        // Format and post the prints that the audio thread queued, a limited amount per tick
+        hv_processPrintMessages(x->x_hv_object, HVCC_MAX_PRINTS_PER_TICK);
+        
+        hv_uint32_t dropped = hv_getNumDroppedPrintMessages(x->x_hv_object);
+        if(dropped) post("[hvcc~]: %u print messages dropped", dropped);
+        
+        hvcc_update_tables(x);
+    }
+    
     clock_delay(x->x_clock, 20);
 }
 
+static void hvcc_sleep_ms(int ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    usleep(ms * 1000);
+#endif
+}
+
+// Allocates new buffers for tables that were resized, they are swapped in at the next block.
+// Pd runs clocks on the audio thread, so this cannot be done from hvcc_tick.
+static void* hvcc_resize_worker(void* arg)
+{
+    t_hvcc* x = (t_hvcc*)arg;
+    while(x->x_resize_running) {
+        pthread_mutex_lock(&x->x_resize_lock);
+        if(x->x_hv_object) hv_processTableResizes(x->x_hv_object);
+        pthread_mutex_unlock(&x->x_resize_lock);
+        hvcc_sleep_ms(HVCC_RESIZE_POLL_MS);
+    }
+    return NULL;
+}
+
 static t_int* hvcc_perform(t_int* w) {
     
     assert(sizeof(t_sample) == sizeof(float));
@@ -228,8 +672,15 @@ static t_int* hvcc_perform(t_int* w) {
     
     int n = (int) (w[x->x_n_in + x->x_n_out + offset]);
     
+    // Remember when this block ended, messages that arrive before the next tick are timed from here
+    x->x_dsp_time = clock_getlogicaltime();
+    x->x_block_ms = n * 1000.0 / hv_getSampleRate(x->x_hv_object);
+    
     hv_process(x->x_hv_object, input_pointers, output_pointers, n);
     
+    // Forward sent messages once the scheduler is done with this tick
+    if(x->x_n_control_out) clock_delay(x->x_send_clock, 0);
+    
     return (w + x->x_n_in + x->x_n_out + offset + 1);
     
 }
@@ -244,10 +695,34 @@ static void* hvcc_new(t_symbol *s, int argc, t_atom *argv)
     
     x->x_n_in = 0;
     x->x_n_out = 0;
+    x->x_n_control_in = 0;
+    x->x_control_inlets = NULL;
+    x->x_control_proxies = NULL;
+    x->x_control_in_names = NULL;
+    x->x_control_in_hashes = NULL;
+    x->x_n_control_out = 0;
+    x->x_control_outlets = NULL;
+    x->x_control_out_names = NULL;
+    x->x_control_out_hashes = NULL;
+    x->x_control_out_map.slots = NULL;
+    x->x_dsp_time = 0;
+    x->x_block_ms = 0;
+    x->x_n_tables = 0;
+    x->x_next_table = 0;
+    x->x_tables = NULL;
     x->x_hv_object = NULL;
     
     x->x_glist = canvas_getcurrent();
     x->x_clock = clock_new(x, (t_method)hvcc_tick);
+    x->x_send_clock = clock_new(x, (t_method)hvcc_send_tick);
+    
+    pthread_mutex_init(&x->x_resize_lock, NULL);
+    x->x_resize_running = 1;
+    if(pthread_create(&x->x_resize_thread, NULL, hvcc_resize_worker, x)) {
+        // Without the worker, tables are resized on the audio thread
+        x->x_resize_running = 0;
+        pd_error(x, "[hvcc~]: could not start the table resize thread");
+    }
     
     if(argc == 1) {
         x->x_state = (char*)atom_getsymbol(argv)->s_name;
@@ -268,6 +743,23 @@ static void* hvcc_new(t_symbol *s, int argc, t_atom *argv)
 static void hvcc_free(t_hvcc* x)
 {
     clock_free(x->x_clock);
+    clock_free(x->x_send_clock);
+    if(x->x_resize_running) {
+        x->x_resize_running = 0;
+        pthread_join(x->x_resize_thread, NULL);
+    }
+    pthread_mutex_destroy(&x->x_resize_lock);
+    // DSP no longer runs this object once it is being freed
+    if(x->x_hv_object) hv_delete(x->x_hv_object);
+    freebytes(x->x_control_inlets, x->x_n_control_in * sizeof(t_inlet*));
+    freebytes(x->x_control_proxies, x->x_n_control_in * sizeof(t_hvcc_inlet));
+    freebytes(x->x_control_in_names, x->x_n_control_in * sizeof(t_symbol*));
+    freebytes(x->x_control_in_hashes, x->x_n_control_in * sizeof(hv_uint32_t));
+    freebytes(x->x_control_outlets, x->x_n_control_out * sizeof(t_outlet*));
+    freebytes(x->x_control_out_names, x->x_n_control_out * sizeof(t_symbol*));
+    freebytes(x->x_control_out_hashes, x->x_n_control_out * sizeof(hv_uint32_t));
+    freebytes(x->x_tables, x->x_n_tables * sizeof(t_hvcc_table));
+    hPh_free(&x->x_control_out_map);
     close_window();
 }
 
@@ -294,6 +786,20 @@ void hvcc_tilde_setup(void)
     
     class_addmethod(hvcc_class, (t_method)hvcc_dsp,
                     gensym("dsp"), 0);
+    
+    class_addmethod(hvcc_class, (t_method)hvcc_param,
+                    gensym("param"), A_GIMME, 0);
+    
+    class_addmethod(hvcc_class, (t_method)hvcc_table,
+                    gensym("table"), A_SYMBOL, A_DEFSYM, 0);
+    
+    class_addmethod(hvcc_class, (t_method)hvcc_table_load,
+                    gensym("load"), A_SYMBOL, A_SYMBOL, 0);
+    
+    hvcc_inlet_class = class_new(gensym("hvcc~ inlet"), 0, 0,
+                                 sizeof(t_hvcc_inlet), CLASS_PD, 0);
+    
+    class_addanything(hvcc_inlet_class, hvcc_inlet_anything);
 }
 
 
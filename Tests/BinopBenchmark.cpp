@@ -0,0 +1,109 @@
+// Measures the cost of control-rate binops, against the dispatch they replaced.
+//
+//   BinopBenchmark [numMessages]
+//
+// A chain of binops of mixed operations is driven with numMessages floats per block, as the generated
+// code would: every binop instance sends to the next one through its own function. The old dispatch
+// switched on the operation at run time in a function of its own, for every message. This is a
+// benchmark and not a test, so it is not run by ctest.
+
+#include "HvControlBinop.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static const int numBlocks = 2000;
+static const int chainLength = 16;
+
+// the operations of the chain, which vary from one binop to the next like in a real patch
+static constexpr BinopType ops[chainLength] = {
+  HV_BINOP_ADD, HV_BINOP_MULTIPLY, HV_BINOP_LESS_THAN, HV_BINOP_SUBTRACT,
+  HV_BINOP_MAX, HV_BINOP_DIVIDE, HV_BINOP_MOD_UNIPOLAR, HV_BINOP_ADD,
+  HV_BINOP_MIN, HV_BINOP_GREATER_THAN_EQL, HV_BINOP_MULTIPLY, HV_BINOP_INT_DIV,
+  HV_BINOP_EQ, HV_BINOP_LOGICAL_OR, HV_BINOP_SUBTRACT, HV_BINOP_BIT_AND
+};
+
+static ControlBinop binops[chainLength];
+static double sum = 0.0; // keeps the outputs live
+
+// the operation before it was resolved at compile time, which was not inlined into the generated code
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noinline))
+#endif
+static float oldBinop_perform_op(BinopType op, float f, float k) {
+  return cBinop_perform_op(op, f, k);
+}
+
+template <int i>
+static void oldBinop_send(HeavyContextInterface *_c, int, const HvMessage *m);
+
+template <int i>
+static void oldBinop_onMessage(HeavyContextInterface *_c, const HvMessage *m, BinopType op) {
+  HvMessage n;
+  msg_initWithFloat(&n, msg_getTimestamp(m), oldBinop_perform_op(op, msg_getFloat(m, 0), binops[i].k));
+  oldBinop_send<i>(_c, 0, &n);
+}
+
+// the table is not constant, so the compiler cannot know the operation of a binop
+static BinopType oldOps[chainLength];
+
+template <int i>
+static void oldBinop_send(HeavyContextInterface *_c, int, const HvMessage *m) {
+  oldBinop_onMessage<i+1>(_c, m, oldOps[i+1]);
+}
+
+template <>
+void oldBinop_send<chainLength-1>(HeavyContextInterface *, int, const HvMessage *m) {
+  sum += msg_getFloat(m, 0);
+}
+
+// the generated code passes every operation as a constant
+template <int i>
+static void binop_send(HeavyContextInterface *_c, int, const HvMessage *m) {
+  cBinop_onMessage(_c, &binops[i+1], ops[i+1], 0, m, &binop_send<i+1>);
+}
+
+template <>
+void binop_send<chainLength-1>(HeavyContextInterface *, int, const HvMessage *m) {
+  sum += msg_getFloat(m, 0);
+}
+
+// sends numMessages floats per block into the chain, and returns the nanoseconds per binop message
+template <typename Entry>
+static double run(int numMessages, Entry entry) {
+  HvMessage m;
+  const auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < numBlocks; ++b) {
+    for (int i = 0; i < numMessages; ++i) {
+      msg_initWithFloat(&m, (hv_uint32_t) b, (float) (i % 97) - 48.0f);
+      entry(&m);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / ((double) numBlocks * numMessages * chainLength);
+}
+
+int main(int argc, const char **argv) {
+  const int numMessages = (argc > 1) ? atoi(argv[1]) : 1000;
+  if (numMessages <= 0) {
+    fprintf(stderr, "usage: %s [numMessages]\n", argv[0]);
+    return 1;
+  }
+
+  for (int i = 0; i < chainLength; ++i) {
+    cBinop_init(&binops[i], 3.0f + i);
+    oldOps[i] = ops[i];
+  }
+
+  printf("%d messages per block through %d binops, ns per binop message\n", numMessages, chainLength);
+  printf("old dispatch: %6.2f\n", run(numMessages, [](const HvMessage *m) {
+    oldBinop_onMessage<0>(nullptr, m, oldOps[0]);
+  }));
+  printf("inlined:      %6.2f\n", run(numMessages, [](const HvMessage *m) {
+    cBinop_onMessage(nullptr, &binops[0], ops[0], 0, m, &binop_send<0>);
+  }));
+
+  if (sum == 0.0) printf("no output\n");
+  return 0;
+}
@@ -0,0 +1,192 @@
+// Measures the cost of env~ in both of its modes, against the kernel it replaced.
+//
+//   EnvelopeBenchmark
+//
+// Each case analyses ten seconds of noise at 48kHz with one window size, and a period of either half
+// the window, as env~ does by default, or one 64-sample block. This is a benchmark and not a test, so
+// it is not run by ctest.
+
+#include "HeavyContext.hpp"
+#include "HvSignalEnvelope.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const double sampleRate = 48000.0;
+static const int numSamples = (int) (10.0*sampleRate);
+
+// the env~ kernel before the ring buffer and the running sum, which shifted the whole buffer by one
+// period after every output
+struct OldEnvelope {
+  int windowSize;
+  int period;
+  int numSamplesInBuffer;
+  float *hanningWeights;
+  float *buffer;
+};
+
+static void oldEnv_init(OldEnvelope *o, SignalEnvelope *e) {
+  // the windows and weights are the same as those of the current kernel
+  o->windowSize = e->windowSize;
+  o->period = e->period;
+  o->numSamplesInBuffer = 0;
+  o->hanningWeights = e->hanningWeights;
+  o->buffer = (float *) hv_malloc(2*o->windowSize*sizeof(float));
+}
+
+static void oldEnv_sendMessage(HeavyContextInterface *_c, OldEnvelope *o, float rms,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
+  rms = (4.342944819032518f * hv_log_f(rms)) + 100.0f;
+  HvMessage *const m = HV_MESSAGE_ON_STACK(1);
+  msg_initWithFloat(m, hv_getCurrentSample(_c) + HV_N_SIMD, (rms < 0.0f) ? 0.0f : rms);
+  hv_scheduleMessageForObject(_c, m, sendMessage, 0);
+  // the old kernel used memcpy, but the ranges overlap when the period is less than half the window
+  memmove(o->buffer, o->buffer+o->period, sizeof(float)*(o->numSamplesInBuffer - o->period));
+  o->numSamplesInBuffer -= o->period;
+}
+
+static void oldEnv_process(HeavyContextInterface *_c, OldEnvelope *o, hv_bInf_t bIn,
+    void (*sendMessage)(HeavyContextInterface *, int, const HvMessage *)) {
+#if HV_SIMD_AVX
+  _mm256_stream_ps(o->buffer+o->numSamplesInBuffer, _mm256_mul_ps(bIn,bIn));
+  o->numSamplesInBuffer += HV_N_SIMD;
+  if (o->numSamplesInBuffer >= o->windowSize) {
+    int n4 = o->windowSize & ~HV_N_SIMD_MASK;
+    __m256 sum = _mm256_setzero_ps();
+    while (n4) {
+      __m256 x = _mm256_load_ps(o->buffer + n4 - HV_N_SIMD);
+      __m256 h = _mm256_load_ps(o->hanningWeights + n4 - HV_N_SIMD);
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(x, h));
+      n4 -= HV_N_SIMD;
+    }
+    sum = _mm256_hadd_ps(sum,sum);
+    sum = _mm256_hadd_ps(sum,sum);
+    oldEnv_sendMessage(_c, o, sum[0]+sum[4], sendMessage);
+  }
+#elif HV_SIMD_SSE
+  _mm_stream_ps(o->buffer+o->numSamplesInBuffer, _mm_mul_ps(bIn,bIn));
+  o->numSamplesInBuffer += HV_N_SIMD;
+  if (o->numSamplesInBuffer >= o->windowSize) {
+    int n4 = o->windowSize & ~HV_N_SIMD_MASK;
+    __m128 sum = _mm_setzero_ps();
+    while (n4) {
+      __m128 x = _mm_load_ps(o->buffer + n4 - HV_N_SIMD);
+      __m128 h = _mm_load_ps(o->hanningWeights + n4 - HV_N_SIMD);
+      sum = _mm_add_ps(sum, _mm_mul_ps(x, h));
+      n4 -= HV_N_SIMD;
+    }
+    sum = _mm_hadd_ps(sum,sum);
+    sum = _mm_hadd_ps(sum,sum);
+    float f;
+    _mm_store_ss(&f, sum);
+    oldEnv_sendMessage(_c, o, f, sendMessage);
+  }
+#elif HV_SIMD_NEON
+  vst1q_f32(o->buffer+o->numSamplesInBuffer, vmulq_f32(bIn,bIn));
+  o->numSamplesInBuffer += HV_N_SIMD;
+  if (o->numSamplesInBuffer >= o->windowSize) {
+    int n4 = o->windowSize & ~HV_N_SIMD_MASK;
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    while (n4) {
+      float32x4_t x = vld1q_f32(o->buffer + n4 - HV_N_SIMD);
+      float32x4_t h = vld1q_f32(o->hanningWeights + n4 - HV_N_SIMD);
+      sum = vaddq_f32(sum, vmulq_f32(x, h));
+      n4 -= HV_N_SIMD;
+    }
+    oldEnv_sendMessage(_c, o, sum[0]+sum[1]+sum[2]+sum[3], sendMessage);
+  }
+#else // HV_SIMD_NONE
+  o->buffer[o->numSamplesInBuffer] = (bIn*bIn);
+  o->numSamplesInBuffer += HV_N_SIMD;
+  if (o->numSamplesInBuffer >= o->windowSize) {
+    float sum = 0.0f;
+    for (int i = 0; i < o->windowSize; ++i) sum += (o->hanningWeights[i] * o->buffer[i]);
+    oldEnv_sendMessage(_c, o, sum, sendMessage);
+  }
+#endif
+}
+
+// a context without a patch, which only delivers the messages of the envelope under test
+class EnvelopeContext : public HeavyContext {
+ public:
+  EnvelopeContext() : HeavyContext(::sampleRate) {}
+  const char *getName() override { return "envelope"; }
+  int getNumInputChannels() override { return 1; }
+  int getNumOutputChannels() override { return 0; }
+  int getParameterInfo(int, HvParameterInfo *) override { return 0; }
+  HvTable *getTableForHash(hv_uint32_t) override { return nullptr; }
+  void scheduleMessageForReceiver(hv_uint32_t, HvMessage *) override {}
+  int process(float **, float **, int n) override { return n; }
+  int processInline(float *, float *, int n) override { return n; }
+  int processInlineInterleaved(float *, float *, int n) override { return n; }
+
+  static void onEnvelope(HeavyContextInterface *c, int, const HvMessage *m) {
+    static_cast<EnvelopeContext *>(c)->sum += msg_getFloat(m,0);
+  }
+
+  // runs the kernel over the input, one vector at a time, and returns the nanoseconds per sample
+  template <typename Kernel>
+  double run(float *in, Kernel kernel) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numSamples; i += HV_N_SIMD) {
+      hv_bufferf_t x;
+      __hv_load_f(in+i, &x);
+      kernel(this, x);
+      blockStartTimestamp += HV_N_SIMD;
+      while (mq_hasMessageBefore(&mq, blockStartTimestamp + HV_N_SIMD)) {
+        MessageNode *const node = mq_peek(&mq);
+        node->sendMessage(this, node->let, node->m);
+        mq_pop(&mq);
+      }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / numSamples;
+  }
+
+  double sum = 0.0; // keeps the outputs live
+};
+
+int main() {
+  float *const in = (float *) hv_malloc(numSamples*sizeof(float));
+  hv_uint32_t r = 1;
+  for (int i = 0; i < numSamples; ++i) {
+    r = r*1664525u + 1013904223u;
+    in[i] = (r >> 8) * (2.0f/(1<<24)) - 1.0f;
+  }
+
+  EnvelopeContext c;
+  printf("%d samples at %g Hz, %d-wide SIMD, ns per sample\n", numSamples, sampleRate, HV_N_SIMD);
+  printf("%8s %8s %8s %8s %10s\n", "window", "period", "old", "hann", "recursive");
+  for (int k = 0; k < 8; ++k) {
+    const int windowSize = 256 << (2*(k/2));
+    SignalEnvelope e;
+    sEnv_init(&e, windowSize, (k % 2) ? 64 : windowSize/2);
+    OldEnvelope o;
+    oldEnv_init(&o, &e);
+
+    // warms up the caches and the message pool
+    if (k == 0) c.run(in, [&](HeavyContextInterface *_c, hv_bInf_t x) {
+      sEnv_process(_c, &e, x, &EnvelopeContext::onEnvelope);
+    });
+    const double oldNs = c.run(in, [&](HeavyContextInterface *_c, hv_bInf_t x) {
+      oldEnv_process(_c, &o, x, &EnvelopeContext::onEnvelope);
+    });
+    sEnv_setRecursive(&e, false);
+    const double hannNs = c.run(in, [&](HeavyContextInterface *_c, hv_bInf_t x) {
+      sEnv_process(_c, &e, x, &EnvelopeContext::onEnvelope);
+    });
+    sEnv_setRecursive(&e, true);
+    const double recursiveNs = c.run(in, [&](HeavyContextInterface *_c, hv_bInf_t x) {
+      sEnv_process(_c, &e, x, &EnvelopeContext::onEnvelope);
+    });
+    printf("%8d %8d %8.2f %8.2f %10.2f\n", e.windowSize, e.period, oldNs, hannNs, recursiveNs);
+
+    hv_free(o.buffer);
+    sEnv_free(&e);
+  }
+
+  if (c.sum == 0.0) printf("no output\n");
+  hv_free(in);
+  return 0;
+}
@@ -0,0 +1,269 @@
+// Opens raw float and WAV files of every format that hMap_open() reads, and checks their samples.
+//
+//   MappedFile [directory]
+//
+// The files are written to the directory first, the current one by default. Every file holds the
+// same ramp in its first channel, and a constant in any other channel, which must not be read.
+
+#include "HvMappedFile.h"
+#include "HvTable.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+typedef std::vector<unsigned char> Bytes;
+
+static float ramp(int i) {
+  return (i % 100) / 100.0f - 0.5f;
+}
+
+static void put16(Bytes &b, hv_uint32_t x) {
+  b.push_back(x & 0xFF);
+  b.push_back((x >> 8) & 0xFF);
+}
+
+static void put32(Bytes &b, hv_uint32_t x) {
+  put16(b, x & 0xFFFF);
+  put16(b, x >> 16);
+}
+
+static void putTag(Bytes &b, const char *tag) {
+  b.insert(b.end(), tag, tag+4);
+}
+
+static void putChunk(Bytes &b, const char *tag, hv_uint32_t numBytes, unsigned char fill) {
+  putTag(b, tag);
+  put32(b, numBytes);
+  b.insert(b.end(), numBytes + (numBytes & 0x1), fill); // padded to an even size
+}
+
+static void putSample(Bytes &b, float x, int formatTag, int bits) {
+  if (formatTag == 3) {
+    hv_uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    put32(b, u);
+  } else if (bits == 16) {
+    put16(b, (hv_uint32_t) (hv_int32_t) lrintf(x * 32768.0f));
+  } else if (bits == 24) {
+    const hv_uint32_t u = (hv_uint32_t) (hv_int32_t) lrintf(x * 8388608.0f);
+    b.push_back(u & 0xFF);
+    b.push_back((u >> 8) & 0xFF);
+    b.push_back((u >> 16) & 0xFF);
+  } else {
+    put32(b, (hv_uint32_t) (hv_int32_t) lrint(x * 2147483648.0));
+  }
+}
+
+struct Wav {
+  int formatTag = 3; // 1 is PCM, 3 is IEEE float
+  bool extensible = false; // the format tag is the subformat of WAVE_FORMAT_EXTENSIBLE
+  int numChannels = 1;
+  int bits = 32;
+  int numFrames = 0;
+  hv_uint32_t junkBytes = 0; // a chunk before the data, which may have an odd size
+  hv_uint32_t missingBytes = 0; // cut from the end of the data, as in a file that was not finalised
+  bool trailer = false; // a chunk after the data
+  bool formatAfterData = false;
+};
+
+static Bytes makeWav(const Wav &w) {
+  Bytes fmt;
+  const int frameBytes = w.numChannels * w.bits/8;
+  put16(fmt, w.extensible ? 0xFFFE : w.formatTag);
+  put16(fmt, w.numChannels);
+  put32(fmt, 48000);
+  put32(fmt, 48000 * frameBytes);
+  put16(fmt, frameBytes);
+  put16(fmt, w.bits);
+  if (w.extensible) {
+    put16(fmt, 22); // the size of the extension
+    put16(fmt, w.bits); // valid bits per sample
+    put32(fmt, 0); // channel mask
+    put16(fmt, w.formatTag); // the first two bytes of the subformat GUID
+    const unsigned char guid[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    fmt.insert(fmt.end(), guid, guid+14);
+  }
+
+  Bytes data;
+  for (int i = 0; i < w.numFrames; ++i) {
+    for (int c = 0; c < w.numChannels; ++c) putSample(data, (c == 0) ? ramp(i) : 0.9f, w.formatTag, w.bits);
+  }
+  const hv_uint32_t dataBytes = (hv_uint32_t) data.size();
+  if (dataBytes & 0x1) data.push_back(0);
+
+  Bytes b;
+  putTag(b, "RIFF");
+  put32(b, 0); // players ignore the size of the RIFF chunk, and so does the parser
+  putTag(b, "WAVE");
+  if (!w.formatAfterData) {
+    putTag(b, "fmt ");
+    put32(b, (hv_uint32_t) fmt.size());
+    b.insert(b.end(), fmt.begin(), fmt.end());
+  }
+  if (w.junkBytes > 0) putChunk(b, "JUNK", w.junkBytes, 0x7F);
+  putTag(b, "data");
+  put32(b, dataBytes);
+  b.insert(b.end(), data.begin(), data.end());
+  if (w.formatAfterData) {
+    putTag(b, "fmt ");
+    put32(b, (hv_uint32_t) fmt.size());
+    b.insert(b.end(), fmt.begin(), fmt.end());
+  }
+  if (w.trailer) putChunk(b, "LIST", 9, 0x7F);
+  b.resize(b.size() - w.missingBytes);
+  return b;
+}
+
+static Bytes makeRaw(int numSamples) {
+  Bytes b;
+  for (int i = 0; i < numSamples; ++i) putSample(b, ramp(i), 3, 32);
+  return b;
+}
+
+static int numFailed = 0;
+
+// Writes the file, opens it and compares its samples with the ramp. A negative number of samples
+// means that the file must be rejected.
+static void check(const std::string &dir, const char *name, const Bytes &b, int numSamples, float tolerance, bool mapped) {
+  const std::string path = dir + "/" + name;
+  FILE *f = fopen(path.c_str(), "wb");
+  if (f == NULL || fwrite(b.data(), 1, b.size(), f) != b.size()) {
+    fprintf(stderr, "%s: could not write %s\n", name, path.c_str());
+    if (f != NULL) fclose(f);
+    ++numFailed;
+    return;
+  }
+  fclose(f);
+
+  HvMappedFile *m = hMap_open(path.c_str());
+  remove(path.c_str());
+  if (numSamples < 0) {
+    if (m != NULL) {
+      fprintf(stderr, "%s: opened a file that is not supported\n", name);
+      hMap_close(m);
+      ++numFailed;
+    } else {
+      printf("%s: rejected\n", name);
+    }
+    return;
+  }
+  if (m == NULL) {
+    fprintf(stderr, "%s: could not be opened\n", name);
+    ++numFailed;
+    return;
+  }
+
+  if ((int) hMap_getNumSamples(m) != numSamples) {
+    fprintf(stderr, "%s: %u samples instead of %d\n", name, hMap_getNumSamples(m), numSamples);
+    hMap_close(m);
+    ++numFailed;
+    return;
+  }
+
+  const char *error = NULL;
+  int i = 0;
+#if !HV_WIN
+  if (m->mapped != mapped) error = mapped ? "copied instead of mapped" : "mapped instead of copied";
+#endif
+  if ((((hv_uintptr_t) hMap_getSamples(m)) & (HV_N_SIMD*sizeof(float) - 1)) != 0) error = "not aligned";
+  for (; error == NULL && i < numSamples; ++i) {
+    if (std::fabs(hMap_getSamples(m)[i] - ramp(i)) > tolerance) error = "wrong sample";
+  }
+  // a table of this length also reads the padding, which must be silent
+  for (; error == NULL && i < (int) (hTable_sizeForLength(numSamples) + HV_N_SIMD); ++i) {
+    if (hMap_getSamples(m)[i] != 0.0f) error = "padding is not silent";
+  }
+  if (error != NULL) {
+    fprintf(stderr, "%s: %s at sample %d\n", name, error, i-1);
+    ++numFailed;
+  } else {
+    printf("%s: %d samples%s\n", name, numSamples, m->mapped ? ", mapped" : "");
+  }
+  hMap_close(m);
+}
+
+int main(int argc, const char **argv) {
+  const std::string dir = (argc > 1) ? argv[1] : ".";
+  const float pcm16 = 1.0f/32768.0f;
+  const float pcm24 = 1.0f/8388608.0f;
+  const float pcm32 = 1.0f/(1 << 30);
+
+  check(dir, "raw.f32", makeRaw(100003), 100003, 0.0f, true);
+  check(dir, "empty.f32", Bytes(), 0, 0.0f, false);
+
+  Wav w;
+  w.numFrames = 5000;
+  check(dir, "float.wav", makeWav(w), 5000, 0.0f, false); // the data starts at byte 44
+
+  w.junkBytes = 12;
+  check(dir, "float_aligned.wav", makeWav(w), 5000, 0.0f, true); // the data starts at byte 64
+
+  w = Wav();
+  w.formatTag = 1;
+  w.bits = 16;
+  w.numFrames = 3001;
+  check(dir, "pcm16.wav", makeWav(w), 3001, pcm16, false);
+  w.bits = 24;
+  check(dir, "pcm24.wav", makeWav(w), 3001, pcm24, false);
+  w.bits = 32;
+  check(dir, "pcm32.wav", makeWav(w), 3001, pcm32, false);
+
+  w = Wav();
+  w.numChannels = 3;
+  w.numFrames = 2000;
+  check(dir, "float_3ch.wav", makeWav(w), 2000, 0.0f, false);
+  w.formatTag = 1;
+  w.bits = 24;
+  w.numChannels = 2;
+  check(dir, "pcm24_2ch.wav", makeWav(w), 2000, pcm24, false);
+
+  w = Wav();
+  w.extensible = true;
+  w.formatTag = 1;
+  w.bits = 16;
+  w.numChannels = 2;
+  w.numFrames = 2000;
+  check(dir, "extensible_pcm16.wav", makeWav(w), 2000, pcm16, false);
+  w.formatTag = 3;
+  w.bits = 32;
+  w.numChannels = 1;
+  check(dir, "extensible_float.wav", makeWav(w), 2000, 0.0f, false);
+
+  // the size of the data chunk is larger than the file, and the last frame is incomplete
+  w = Wav();
+  w.formatTag = 1;
+  w.bits = 16;
+  w.numChannels = 2;
+  w.numFrames = 1000;
+  w.missingBytes = 4*400 + 2;
+  check(dir, "truncated.wav", makeWav(w), 599, pcm16, false);
+
+  // chunks of odd size are followed by a pad byte
+  w = Wav();
+  w.formatTag = 1;
+  w.bits = 24;
+  w.numFrames = 1001;
+  w.junkBytes = 5;
+  w.trailer = true;
+  check(dir, "odd_chunks.wav", makeWav(w), 1001, pcm24, false);
+
+  w = Wav();
+  w.numFrames = 100;
+  w.formatAfterData = true;
+  check(dir, "format_after_data.wav", makeWav(w), -1, 0.0f, false);
+  w = Wav();
+  w.formatTag = 1;
+  w.bits = 8;
+  w.numFrames = 100;
+  check(dir, "pcm8.wav", makeWav(w), -1, 0.0f, false);
+  w.formatTag = 6; // A-law
+  check(dir, "alaw.wav", makeWav(w), -1, 0.0f, false);
+  w.formatTag = 3;
+  w.bits = 64;
+  check(dir, "float64.wav", makeWav(w), -1, 0.0f, false);
+
+  return (numFailed > 0) ? 1 : 0;
+}
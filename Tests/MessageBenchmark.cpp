@@ -0,0 +1,124 @@
+// Measures how fast messages pass through the message queue and how much of the message pool they
+// take, against the element layout before elements were packed into 8 bytes.
+//
+//   MessageBenchmark
+//
+// Each case keeps a number of messages of one size pending at random times within the next block,
+// and delivers them in order, like a patch with many delays. This is a benchmark and not a test, so it
+// is not run by ctest.
+
+#include "HeavyContext.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+static const double sampleRate = 48000.0;
+static const int blockSize = 64;
+static const int numPending = 256;
+static const int numBlocks = 20000;
+
+// the element before it was packed, which held a pointer to its symbol string. A 4-byte type and an
+// 8-byte union take 16 bytes on 64-bit platforms, and the strings were copied after the elements.
+struct OldElement {
+  ElementType type;
+  union {
+    float f;
+    const char *s;
+    hv_uint32_t h;
+  } data;
+};
+
+struct OldMessage {
+  hv_uint32_t timestamp;
+  hv_uint16_t numElements;
+  hv_uint16_t numBytes;
+  OldElement elem;
+};
+
+static hv_size_t oldCoreSize(int numElements) {
+  return sizeof(OldMessage) + (numElements-1) * sizeof(OldElement);
+}
+
+// the size class of the message pool that a message of this size is taken from
+static hv_size_t poolChunkSize(hv_size_t numBytes) {
+  hv_size_t chunkSize = ((hv_size_t) 1) << MP_MIN_CHUNK_SIZE_LOG2;
+  while (chunkSize < numBytes) chunkSize <<= 1;
+  return chunkSize;
+}
+
+// a context without a patch, which only delivers the messages scheduled by the benchmark
+class MessageContext : public HeavyContext {
+ public:
+  MessageContext() : HeavyContext(::sampleRate, 64) {}
+  const char *getName() override { return "message"; }
+  int getNumInputChannels() override { return 0; }
+  int getNumOutputChannels() override { return 0; }
+  int getParameterInfo(int, HvParameterInfo *) override { return 0; }
+  HvTable *getTableForHash(hv_uint32_t) override { return nullptr; }
+  void scheduleMessageForReceiver(hv_uint32_t, HvMessage *) override {}
+  int process(float **, float **, int n) override { return n; }
+  int processInline(float *, float *, int n) override { return n; }
+  int processInlineInterleaved(float *, float *, int n) override { return n; }
+
+  static void onMessage(HeavyContextInterface *c, int, const HvMessage *m) {
+    MessageContext *const x = static_cast<MessageContext *>(c);
+    x->sum += msg_getFloat(m, 0);
+    ++x->numDelivered;
+  }
+
+  // schedules numPending messages per block and delivers them, and returns the nanoseconds per message
+  double run(int numElements) {
+    HvMessage *const m = HV_MESSAGE_ON_STACK(numElements);
+    hv_uint32_t r = 1;
+    numDelivered = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < numBlocks; ++b) {
+      for (int i = 0; i < numPending; ++i) {
+        r = r*1664525u + 1013904223u;
+        msg_init(m, numElements, blockStartTimestamp + (r >> 8) % blockSize);
+        msg_setFloat(m, 0, (float) i);
+        for (int k = 1; k < numElements; ++k) {
+          if (k % 2) msg_setBuiltinSymbol(m, k, HV_SYMBOL_bang);
+          else msg_setFloat(m, k, (float) k);
+        }
+        scheduleMessageForObject(m, &MessageContext::onMessage, 0);
+      }
+      blockStartTimestamp += blockSize;
+      while (mq_hasMessageBefore(&mq, blockStartTimestamp)) {
+        MessageNode *const node = mq_peek(&mq);
+        node->sendMessage(this, node->let, node->m);
+        mq_pop(&mq);
+      }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    poolBytes = mq.mp.bufferIndex;
+    return std::chrono::duration<double, std::nano>(end - start).count() / numDelivered;
+  }
+
+  double sum = 0.0; // keeps the outputs live
+  long numDelivered = 0;
+  hv_size_t poolBytes = 0; // the most that the message pool held at once
+};
+
+int main() {
+  printf("%d messages pending per block of %d samples, ns per message, bytes per message and pool bytes\n",
+      numPending, blockSize);
+  printf("%8s %8s %8s %8s %8s %8s %10s %10s\n",
+      "elements", "old", "new", "old pool", "new pool", "ns", "old peak", "new peak");
+  for (int numElements = 1; numElements <= 8; numElements *= 2) {
+    // a new context for every size, so that the pool only holds messages of that size
+    MessageContext c;
+    const double ns = c.run(numElements);
+
+    // the old layout would have needed the same number of its larger chunks
+    const hv_size_t oldSize = oldCoreSize(numElements);
+    const hv_size_t newSize = msg_getCoreSize(numElements);
+    const hv_size_t newPeak = c.poolBytes;
+    const hv_size_t oldPeak = newPeak / poolChunkSize(newSize) * poolChunkSize(oldSize);
+    printf("%8d %8d %8d %8d %8d %8.2f %10d %10d\n", numElements, (int) oldSize, (int) newSize,
+        (int) poolChunkSize(oldSize), (int) poolChunkSize(newSize), ns, (int) oldPeak, (int) newPeak);
+
+    if (c.sum == 0.0) printf("no output\n");
+  }
+  return 0;
+}
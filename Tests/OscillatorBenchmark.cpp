@@ -0,0 +1,109 @@
+// Measures the cost of one voice of each oscillator, against the naive saw made from phasor~.
+//
+//   OscillatorBenchmark [numVoices]
+//
+// Each voice plays its own frequency, spread over six octaves, for ten seconds of audio at 48kHz.
+// This is a benchmark and not a test, so it is not run by ctest.
+
+#include "HeavyContext.hpp"
+#include "HvSignalOscillator.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const double sampleRate = 48000.0;
+static const int blockSize = 64;
+static const int numBlocks = (int) (10.0*sampleRate/blockSize);
+static const int tableLength = 2048;
+
+// the naive saw the band-limited kernels replace
+static inline void naiveSaw(SignalPhasor *o, hv_bInf_t bIn, hv_bOutf_t bOut) {
+  hv_bufferf_t p, two, one;
+  __hv_phasor_f(o, bIn, &p);
+  __hv_osc_set_f(2.0f, &two);
+  __hv_osc_set_f(1.0f, &one);
+  __hv_fms_f(p, two, one, bOut);
+}
+
+// a context without a patch, which only holds the wavetables
+class OscillatorContext : public HeavyContext {
+ public:
+  OscillatorContext() : HeavyContext(::sampleRate) {}
+  const char *getName() override { return "oscillator"; }
+  int getNumInputChannels() override { return 0; }
+  int getNumOutputChannels() override { return 1; }
+  int getParameterInfo(int, HvParameterInfo *) override { return 0; }
+  HvTable *getTableForHash(hv_uint32_t) override { return nullptr; }
+  void scheduleMessageForReceiver(hv_uint32_t, HvMessage *) override {}
+  int process(float **, float **, int n) override { return n; }
+  int processInline(float *, float *, int n) override { return n; }
+  int processInlineInterleaved(float *, float *, int n) override { return n; }
+};
+
+// runs every voice through the whole signal, and returns the nanoseconds per voice per sample
+template <typename Voice, typename Kernel>
+static double run(std::vector<Voice> &voices, const std::vector<float> &frequencies, Kernel kernel) {
+  alignas(32) float freq[HV_N_SIMD];
+  alignas(32) float out[HV_N_SIMD];
+  hv_bufferf_t sum;
+  __hv_zero_f(&sum);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < numBlocks; ++b) {
+    for (size_t v = 0; v < voices.size(); ++v) {
+      for (int k = 0; k < HV_N_SIMD; ++k) freq[k] = frequencies[v];
+      hv_bufferf_t f, o;
+      __hv_load_f(freq, &f);
+      for (int i = 0; i < blockSize; i += HV_N_SIMD) {
+        kernel(&voices[v], f, &o);
+        __hv_add_f(sum, o, &sum);
+      }
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  // keeps the outputs live
+  __hv_store_f(out, sum);
+  if (std::isnan(out[0])) printf("nan\n");
+  const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  return ns / ((double) voices.size() * numBlocks * blockSize);
+}
+
+int main(int argc, const char **argv) {
+  const int numVoices = (argc > 1) ? atoi(argv[1]) : 32;
+  if (numVoices <= 0) {
+    fprintf(stderr, "usage: %s [numVoices]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<float> frequencies(numVoices);
+  for (int v = 0; v < numVoices; ++v) frequencies[v] = 55.0f * std::pow(2.0f, 6.0f*v/numVoices);
+
+  std::vector<SignalPhasor> phasors(numVoices);
+  std::vector<SignalOscillator> oscillators(numVoices);
+  std::vector<SignalWavetable> wavetables(numVoices);
+
+  OscillatorContext c;
+  HvTable table;
+  hTable_init(&table, tableLength);
+  for (int i = 0; i < tableLength; ++i) table.buffer[i] = 2.0f*i/tableLength - 1.0f;
+  for (int v = 0; v < numVoices; ++v) {
+    sPhasor_init(&phasors[v], sampleRate);
+    sOsc_init(&oscillators[v], sampleRate);
+    sWavetable_init(&c, &wavetables[v], &table, sampleRate);
+  }
+
+  printf("%d voices, %d samples at %g Hz, %d-wide SIMD\n", numVoices, numBlocks*blockSize, sampleRate, HV_N_SIMD);
+  printf("naive saw:  %6.2f ns per voice per sample\n", run(phasors, frequencies, naiveSaw));
+  printf("saw:        %6.2f ns per voice per sample\n", run(oscillators, frequencies, __hv_saw_f));
+  printf("square:     %6.2f ns per voice per sample\n", run(oscillators, frequencies, __hv_square_f));
+  printf("triangle:   %6.2f ns per voice per sample\n", run(oscillators, frequencies, __hv_triangle_f));
+  printf("wavetable:  %6.2f ns per voice per sample\n", run(wavetables, frequencies, __hv_wavetable_f));
+
+  for (int v = 0; v < numVoices; ++v) sWavetable_free(&wavetables[v]);
+  hTable_free(&table);
+  return 0;
+}
@@ -0,0 +1,197 @@
+// Measures the cost of samphold~ with random and periodic triggers, against the kernel it replaced.
+//
+//   SampholdBenchmark
+//
+// Each case holds ten seconds of noise at 48kHz with one pattern of triggers. The old kernel switched
+// on the trigger pattern of every vector, which the branch predictor cannot follow when the triggers
+// are random. This is a benchmark and not a test, so it is not run by ctest.
+
+#include "HvHeavyInternal.h"
+#include "HvSignalSamphold.h"
+
+#include <chrono>
+#include <cstdio>
+
+static const double sampleRate = 48000.0;
+static const int numSamples = (int) (10.0*sampleRate);
+
+// the samphold~ kernel before it was made branch-free. Only the x86 kernels are replicated, and any
+// other target runs the lane loop of the old AVX kernel.
+static inline void oldSamphold(SignalSamphold *o, hv_bInf_t bIn0, hv_bInf_t bIn1, hv_bOutf_t bOut) {
+#if HV_SIMD_SSE && !HV_SIMD_AVX
+  switch (_mm_movemask_ps(bIn1)) {
+    default:
+    case 0x0: *bOut = o->s; break;
+    case 0x1: {
+      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(0,0,0,0));
+      o->s = *bOut;
+      break;
+    }
+    case 0x2: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(1,1,1,1));
+      *bOut = _mm_blend_ps(o->s, x, 0xE);
+      o->s = x;
+      break;
+    }
+    case 0x3: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(1,1,1,1));
+      *bOut = _mm_blend_ps(bIn0, x, 0xC);
+      o->s = x;
+      break;
+    }
+    case 0x4: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
+      *bOut = _mm_blend_ps(o->s, x, 0xC);
+      o->s = x;
+      break;
+    }
+    case 0x5: {
+      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,0,0));
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
+      break;
+    }
+    case 0x6: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,1,0));
+      *bOut = _mm_blend_ps(o->s, x, 0xE);
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
+      break;
+    }
+    case 0x7: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(2,2,2,2));
+      *bOut = _mm_blend_ps(bIn0, x, 0x8);
+      o->s = x;
+      break;
+    }
+    case 0x8: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      *bOut = _mm_blend_ps(o->s, x, 0x8);
+      o->s = x;
+      break;
+    }
+    case 0x9: {
+      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,0,0,0));
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+    case 0xA: {
+      const __m128 x = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,1,1,0));
+      *bOut = _mm_blend_ps(o->s, x, 0xE);
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+    case 0xB: {
+      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,1,1,0));
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+    case 0xC: {
+      *bOut = _mm_blend_ps(o->s, bIn0, 0xC);
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+    case 0xD: {
+      *bOut = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,2,0,0));
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+    case 0xE: {
+      *bOut = _mm_blend_ps(o->s, bIn0, 0xE);
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+    case 0xF: {
+      *bOut = bIn0;
+      o->s = _mm_shuffle_ps(bIn0, bIn0, _MM_SHUFFLE(3,3,3,3));
+      break;
+    }
+  }
+#elif HV_SIMD_NONE
+  if (bIn1 != 0.0f) o->s = bIn0;
+  *bOut = o->s;
+#else
+  alignas(32) float x[HV_N_SIMD];
+  alignas(32) float t[HV_N_SIMD];
+  alignas(32) float y[HV_N_SIMD];
+  alignas(32) float h[HV_N_SIMD];
+  __hv_store_f(x, bIn0);
+  __hv_store_f(t, bIn1);
+  __hv_store_f(h, o->s);
+  float s = h[0];
+  for (int i = 0; i < HV_N_SIMD; ++i) {
+    if (t[i] != 0.0f) s = x[i];
+    y[i] = s;
+  }
+  for (int i = 0; i < HV_N_SIMD; ++i) h[i] = s;
+  __hv_load_f(y, bOut);
+  __hv_load_f(h, &o->s);
+#endif
+}
+
+static float *in;
+static float *trig;
+static double sum = 0.0; // keeps the outputs live
+
+// holds the input with the triggers, one vector at a time, and returns the nanoseconds per sample
+template <typename Kernel>
+static double run(Kernel kernel) {
+  SignalSamphold s;
+  sSamphold_init(&s);
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < numSamples; i += HV_N_SIMD) {
+    // the triggers are full lane masks, as made by the comparison operators
+    hv_bufferf_t b, t, z, o;
+    __hv_load_f(in+i, &b);
+    __hv_load_f(trig+i, &t);
+    __hv_zero_f(&z);
+    __hv_neq_f(t, z, &t);
+    kernel(&s, b, t, &o);
+    __hv_store_f(in+i, o);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  sum += in[numSamples-1];
+  return std::chrono::duration<double, std::nano>(end - start).count() / numSamples;
+}
+
+int main() {
+  in = (float *) hv_malloc(numSamples*sizeof(float));
+  trig = (float *) hv_malloc(numSamples*sizeof(float));
+  float *const noise = (float *) hv_malloc(numSamples*sizeof(float));
+  hv_uint32_t r = 1;
+  for (int i = 0; i < numSamples; ++i) {
+    r = r*1664525u + 1013904223u;
+    noise[i] = (r >> 8) * (2.0f/(1<<24)) - 1.0f;
+  }
+
+  // a negative period makes random triggers, which fire on one sample in every -period on average
+  static const int periods[] = {-2, -8, 1, 7, 64, numSamples};
+  printf("%d samples at %g Hz, %d-wide SIMD, ns per sample\n", numSamples, sampleRate, HV_N_SIMD);
+  printf("%-16s %8s %8s\n", "triggers", "old", "new");
+  for (int period : periods) {
+    r = 1;
+    for (int i = 0; i < numSamples; ++i) {
+      r = r*1664525u + 1013904223u;
+      trig[i] = ((period < 0) ? ((r >> 16) % -period == 0) : (i % period == 0)) ? 1.0f : 0.0f;
+    }
+
+    hv_memcpy(in, noise, numSamples*sizeof(float));
+    const double oldNs = run([](SignalSamphold *s, hv_bInf_t b, hv_bInf_t t, hv_bOutf_t o) {
+      oldSamphold(s, b, t, o);
+    });
+    hv_memcpy(in, noise, numSamples*sizeof(float));
+    const double newNs = run([](SignalSamphold *s, hv_bInf_t b, hv_bInf_t t, hv_bOutf_t o) {
+      __hv_samphold_f(s, b, t, o);
+    });
+
+    char name[32];
+    if (period < 0) snprintf(name, sizeof(name), "random 1/%d", -period);
+    else if (period < numSamples) snprintf(name, sizeof(name), "every %d", period);
+    else snprintf(name, sizeof(name), "once");
+    printf("%-16s %8.2f %8.2f\n", name, oldNs, newNs);
+  }
+
+  if (sum == 0.0) printf("no output\n");
+  hv_free(noise);
+  hv_free(trig);
+  hv_free(in);
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Runs the SIMD kernels that have hand-written variants per instruction set over fixed inputs.
+//
+//   SimdKernels <file>            writes the outputs to the file
+//   SimdKernels --compare <file>  fails if the outputs differ in any bit from the ones in the file
+//
+// Built once for SSE and once for AVX, so that the AVX kernels can be checked against the SSE ones.
+
+#include "HvHeavyInternal.h"
+#include "HvSignalConvolution.h"
+#include "HvSignalSamphold.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// ctest reports a test that returns this as skipped
+#define SKIP_RETURN_CODE 77
+
+static const int numSamples = 4096;
+static const int numCoeffs = 64;
+
+// aligned for the SIMD loads and stores of the kernels
+alignas(32) static float in[numSamples];
+alignas(32) static float trig[numSamples];
+alignas(32) static float outputs[3][numSamples];
+static const char *const outputNames[3] = {"log2", "samphold", "convolution"};
+
+static void makeInputs() {
+  hv_uint32_t r = 1;
+  for (int i = 0; i < numSamples; ++i) {
+    r = r*1664525u + 1013904223u;
+    in[i] = (r >> 8) * (2.0f/(1<<24)) - 1.0f;
+    trig[i] = ((r >> 3) % 5 == 0) ? 1.0f : 0.0f;
+  }
+}
+
+static void runLog2(float *out) {
+  for (int i = 0; i < numSamples; i += HV_N_SIMD) {
+    alignas(32) float x[HV_N_SIMD];
+    for (int k = 0; k < HV_N_SIMD; ++k) x[k] = std::fabs(in[i+k]) * 1000.0f + 1e-3f;
+    hv_bufferf_t b, o;
+    __hv_load_f(x, &b);
+    __hv_log2_f(b, &o);
+    __hv_store_f(out+i, o);
+  }
+}
+
+static void runSamphold(float *out) {
+  SignalSamphold s;
+  sSamphold_init(&s);
+  for (int i = 0; i < numSamples; i += HV_N_SIMD) {
+    // the triggers are full lane masks, as made by the comparison operators
+    hv_bufferf_t b, t, z, o;
+    __hv_load_f(in+i, &b);
+    __hv_load_f(trig+i, &t);
+    __hv_zero_f(&z);
+    __hv_neq_f(t, z, &t);
+    __hv_samphold_f(&s, b, t, &o);
+    __hv_store_f(out+i, o);
+  }
+}
+
+static void runConvolution(float *out) {
+  HvTable coeffs;
+  hTable_init(&coeffs, numCoeffs);
+  for (int i = 0; i < numCoeffs; ++i) coeffs.buffer[i] = std::sin(i * 0.3f) / (i+1);
+  SignalConvolution c;
+  sConv_init(&c, &coeffs, 2*numCoeffs);
+  for (int i = 0; i < numSamples; i += HV_N_SIMD) {
+    hv_bufferf_t b, o;
+    __hv_load_f(in+i, &b);
+    __hv_conv_f(&c, b, &o);
+    __hv_store_f(out+i, o);
+  }
+  sConv_free(&c);
+  hTable_free(&coeffs);
+}
+
+int main(int argc, const char **argv) {
+  const bool compare = (argc == 3) && !strcmp(argv[1], "--compare");
+  if (argc != 2 && !compare) {
+    fprintf(stderr, "usage: %s [--compare] <file>\n", argv[0]);
+    return 1;
+  }
+#if HV_SIMD_AVX && (defined(__GNUC__) || defined(__clang__))
+  if (!__builtin_cpu_supports("avx")) {
+    printf("AVX is not supported by this processor\n");
+    return SKIP_RETURN_CODE;
+  }
+#endif
+
+  makeInputs();
+  runLog2(outputs[0]);
+  runSamphold(outputs[1]);
+  runConvolution(outputs[2]);
+
+  FILE *f = fopen(argv[argc-1], compare ? "rb" : "wb");
+  if (f == NULL) {
+    fprintf(stderr, "could not open %s\n", argv[argc-1]);
+    return 1;
+  }
+
+  int numFailed = 0;
+  for (int k = 0; k < 3; ++k) {
+    const float *const out = outputs[k];
+    if (!compare) {
+      fwrite(out, sizeof(float), numSamples, f);
+      continue;
+    }
+    static float expected[numSamples];
+    if (fread(expected, sizeof(float), numSamples, f) != (size_t) numSamples) {
+      fprintf(stderr, "%s: the file is too short\n", outputNames[k]);
+      ++numFailed;
+      break;
+    }
+    int i = 0;
+    while (i < numSamples && !memcmp(expected+i, out+i, sizeof(float))) ++i;
+    if (i < numSamples) {
+      fprintf(stderr, "%s: sample %d is %.9g instead of %.9g\n", outputNames[k], i, out[i], expected[i]);
+      ++numFailed;
+    } else {
+      printf("%s: %d samples match\n", outputNames[k], numSamples);
+    }
+  }
+  fclose(f);
+  return (numFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+// Checks that the hash evaluated by the compiler is the same as the one of the runtime.
+//
+//   StringHash
+//
+// getHashForString() hashes names at compile time with __hv_utils_string_to_hash(), while messages,
+// the symbol table and the host hash them at run time with hv_string_to_hash(). The hashes of string
+// literals of every tail length are computed by the compiler, and random strings are compared at run
+// time, including bytes above 0x7F, which are sign extended.
+
+#include "HvUtils.h"
+
+#include <cstdio>
+
+struct Literal {
+  const char *s;
+  hv_uint32_t hash;
+};
+
+// the hashes are constant expressions, so these are computed by the compiler
+static constexpr Literal literals[] = {
+  {"", __hv_utils_string_to_hash("")},
+  {"a", __hv_utils_string_to_hash("a")},
+  {"ab", __hv_utils_string_to_hash("ab")},
+  {"abc", __hv_utils_string_to_hash("abc")},
+  {"bang", __hv_utils_string_to_hash("bang")},
+  {"freq~", __hv_utils_string_to_hash("freq~")},
+  {"__hv_i", __hv_utils_string_to_hash("__hv_i")},
+  {"\xC3\xA9t\xC3\xA9!", __hv_utils_string_to_hash("\xC3\xA9t\xC3\xA9!")},
+};
+
+static_assert(__hv_utils_string_to_hash(nullptr) == 0, "a NULL string hashes to 0");
+static_assert(__hv_utils_string_to_hash("a") != __hv_utils_string_to_hash("b"), "the hash is evaluated by the compiler");
+
+int main() {
+  int numFailed = 0;
+  for (const Literal &l : literals) {
+    if (l.hash != hv_string_to_hash(l.s)) {
+      fprintf(stderr, "\"%s\": 0x%08X at compile time, 0x%08X at run time\n", l.s, l.hash, hv_string_to_hash(l.s));
+      ++numFailed;
+    }
+  }
+
+  hv_uint32_t r = 1;
+  char s[8];
+  for (int i = 0; i < 100000; ++i) {
+    const int len = i % 8;
+    for (int k = 0; k < len; ++k) {
+      r = r*1664525u + 1013904223u;
+      s[k] = (char) ((r >> 24) % 255 + 1);
+    }
+    s[len] = '\0';
+    if (__hv_utils_string_to_hash(s) != hv_string_to_hash(s)) {
+      if (numFailed++ < 10) fprintf(stderr, "a string of length %d hashes differently\n", len);
+    }
+  }
+
+  if (numFailed == 0) printf("the hashes match\n");
+  return (numFailed > 0) ? 1 : 0;
+}
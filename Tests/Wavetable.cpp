@@ -0,0 +1,196 @@
+// Checks the mip-maps of wavetables, and that they are rebuilt when their table changes.
+//
+//   Wavetable
+//
+// The mip-maps are compared with ones made by a direct DFT of the table, for lengths that are and
+// are not powers of two. Tables are then changed by the host and by the patch, with and without a
+// table resize queue, and the new mip-maps must only be heard from the block after they were built.
+
+#include "HeavyContext.hpp"
+#include "HvSignalOscillator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const hv_uint32_t tableHash = 1;
+
+// a context without a patch, which only holds one table
+class WavetableContext : public HeavyContext {
+ public:
+  WavetableContext() : HeavyContext(48000.0) {}
+  const char *getName() override { return "wavetable"; }
+  int getNumInputChannels() override { return 0; }
+  int getNumOutputChannels() override { return 1; }
+  int getParameterInfo(int, HvParameterInfo *) override { return 0; }
+  HvTable *getTableForHash(hv_uint32_t h) override { return (h == tableHash) ? &table : nullptr; }
+  void scheduleMessageForReceiver(hv_uint32_t, HvMessage *) override {}
+  int process(float **, float **, int n) override {
+    applyPendingUpdates();
+    return n;
+  }
+  int processInline(float *, float *, int n) override { return n; }
+  int processInlineInterleaved(float *, float *, int n) override { return n; }
+
+  HvTable table;
+};
+
+static int numFailed = 0;
+
+static void fill(HvTable *t, int seed) {
+  for (hv_uint32_t i = 0; i < hTable_getLength(t); ++i) {
+    t->buffer[i] = std::sin(i * 0.37f * seed) + ((i*7919) % 13) / 13.0f - 0.5f;
+  }
+}
+
+// The mip-maps by a direct DFT, as they were built before, O(numLevels*n^2).
+static std::vector<float> directLevels(const float *x, int n) {
+  std::vector<float> levels;
+  std::vector<double> re(n/2+1), im(n/2+1);
+  for (int k = 0; k <= n/2; ++k) {
+    double a = 0.0, b = 0.0;
+    for (int i = 0; i < n; ++i) {
+      const double p = 2.0*M_PI*(double) (((hv_uint64_t) k*i) % n)/n;
+      a += x[i] * std::cos(p);
+      b += x[i] * std::sin(p);
+    }
+    const double g = (k == 0 || 2*k == n) ? 1.0/n : 2.0/n;
+    re[k] = a * g;
+    im[k] = b * g;
+  }
+  for (int h = n/2; ; h >>= 1) {
+    for (int i = 0; i <= n; ++i) {
+      double v = re[0];
+      for (int k = 1; k <= h; ++k) {
+        const double p = 2.0*M_PI*(double) (((hv_uint64_t) k*i) % n)/n;
+        v += re[k] * std::cos(p) + im[k] * std::sin(p);
+      }
+      levels.push_back((float) v);
+    }
+    if (h <= 1) break;
+  }
+  return levels;
+}
+
+static void check(const char *name, const SignalWavetable &w, const float *x, int n) {
+  const std::vector<float> expected = directLevels(x, n);
+  if (w.length != n || (size_t) (w.numLevels*(w.length+1)) != expected.size()) {
+    fprintf(stderr, "%s: %d levels of %d samples instead of %d of %d\n", name,
+        w.numLevels, w.length, (int) expected.size()/(n+1), n);
+    ++numFailed;
+    return;
+  }
+  double error = 0.0;
+  for (size_t i = 0; i < expected.size(); ++i) error = std::fmax(error, std::fabs(w.levels[i] - expected[i]));
+  if (error > 1e-5) {
+    fprintf(stderr, "%s: the mip-maps differ by %g\n", name, error);
+    ++numFailed;
+  } else {
+    printf("%s: %d levels of %d samples\n", name, w.numLevels, n);
+  }
+}
+
+static void fail(const char *name, const char *error) {
+  fprintf(stderr, "%s: %s\n", name, error);
+  ++numFailed;
+}
+
+int main() {
+  const int lengths[] = {1, 2, 3, 7, 64, 600, 2048, 3001};
+  for (int n : lengths) {
+    WavetableContext c;
+    hTable_init(&c.table, n);
+    fill(&c.table, 1);
+    SignalWavetable w;
+    sWavetable_init(&c, &w, &c.table, 48000.0);
+    char name[32];
+    snprintf(name, sizeof(name), "length %d", n);
+    check(name, w, c.table.buffer, n);
+    sWavetable_free(&w);
+    hTable_free(&c.table);
+  }
+
+  // a longer table than HV_WAVETABLE_MAX_LENGTH keeps the harmonics that fit
+  {
+    WavetableContext c;
+    const int n = 3*HV_WAVETABLE_MAX_LENGTH + 1;
+    const int h = HV_WAVETABLE_MAX_LENGTH/2 - 1;
+    hTable_init(&c.table, n);
+    for (int i = 0; i < n; ++i) c.table.buffer[i] = (float) (0.3 + std::sin(2.0*M_PI*i/n) + 0.5*std::cos(2.0*M_PI*h*i/n));
+    SignalWavetable w;
+    sWavetable_init(&c, &w, &c.table, 48000.0);
+    double error = 0.0;
+    for (int i = 0; i < w.length; ++i) {
+      error = std::fmax(error, std::fabs(w.levels[i] - (0.3 + std::sin(2.0*M_PI*i/w.length) + 0.5*std::cos(2.0*M_PI*h*i/w.length))));
+    }
+    if (w.length != HV_WAVETABLE_MAX_LENGTH || error > 1e-5) fail("long table", "harmonics were lost");
+    else printf("long table: played with %d samples\n", w.length);
+    sWavetable_free(&w);
+    hTable_free(&c.table);
+  }
+
+  // without a resize queue, the mip-maps are swapped in by processTableResizes()
+  {
+    WavetableContext c;
+    hTable_init(&c.table, 256);
+    fill(&c.table, 1);
+    SignalWavetable w;
+    sWavetable_init(&c, &w, &c.table, 48000.0);
+    if (c.processTableResizes() != 0) fail("no queue", "rebuilt an unchanged table");
+    c.setLengthForTable(tableHash, 300);
+    fill(&c.table, 2);
+    if (c.processTableResizes() != 1) fail("no queue", "not rebuilt");
+    check("no queue", w, c.table.buffer, 300);
+
+    // the host writes new samples without changing the size
+    c.setLengthForTable(tableHash, 300);
+    fill(&c.table, 3);
+    c.processTableResizes();
+    check("same length", w, c.table.buffer, 300);
+    sWavetable_free(&w);
+    hTable_free(&c.table);
+  }
+
+  // with a resize queue, the mip-maps are swapped in at the start of the next block
+  {
+    WavetableContext c;
+    c.setTableResizeQueueSize(1);
+    hTable_init(&c.table, 128);
+    fill(&c.table, 1);
+    SignalWavetable w;
+    sWavetable_init(&c, &w, &c.table, 48000.0);
+    c.setLengthForTable(tableHash, 1000);
+    fill(&c.table, 2);
+    if (c.processTableResizes() != 1) fail("host resize", "not rebuilt");
+    if (w.length != 128) fail("host resize", "swapped in before the block");
+    c.process(nullptr, nullptr, 64);
+    check("host resize", w, c.table.buffer, 1000);
+
+    // a resize by the patch gets a new buffer first, and the mip-maps at the next call
+    hv_requestTableResize(&c, &c.table, 2000);
+    c.processTableResizes();
+    c.process(nullptr, nullptr, 64);
+    if (hTable_getLength(&c.table) != 2000) fail("patch resize", "the table was not resized");
+    c.processTableResizes();
+    c.process(nullptr, nullptr, 64);
+    check("patch resize", w, c.table.buffer, 2000);
+
+    // mip-maps in flight when the queue is reset are built again
+    c.setLengthForTable(tableHash, 50);
+    fill(&c.table, 3);
+    c.processTableResizes();
+    c.setTableResizeQueueSize(1);
+    c.processTableResizes();
+    c.process(nullptr, nullptr, 64);
+    check("queue reset", w, c.table.buffer, 50);
+    c.processTableResizes();
+    sWavetable_free(&w);
+    hTable_free(&c.table);
+  }
+
+  return (numFailed > 0) ? 1 : 0;
+}